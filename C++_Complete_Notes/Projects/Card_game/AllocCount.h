@@ -0,0 +1,52 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Allocation tracking: replaces the global operator new/delete so that every heap allocation bumps a
+// per-thread counter. Reading the counter before and after a piece of code tells how many allocations it made
+// on the calling thread, which is how --alloc-check proves the simulation loop stays off the heap.
+// These are replacement functions, so this header must be included by exactly one translation unit of a program.
+// They are kept out of line: inlined, GCC sees free() called on memory from operator new and warns about a mismatch.
+#define ALLOC_COUNT_HOOK __attribute__((noinline))
+
+namespace AllocCount
+{
+    inline thread_local std::uint64_t allocations {0};
+
+    // Allocations made so far by the calling thread:
+    inline std::uint64_t current() { return allocations; }
+}
+
+ALLOC_COUNT_HOOK void* operator new(std::size_t size)
+{
+    ++AllocCount::allocations;
+    if (void* memory { std::malloc(size ? size : 1) })
+        return memory;
+    throw std::bad_alloc{};
+}
+ALLOC_COUNT_HOOK void* operator new[](std::size_t size) { return ::operator new(size); }
+ALLOC_COUNT_HOOK void* operator new(std::size_t size, std::align_val_t align)
+{
+    ++AllocCount::allocations;
+    const auto alignment { static_cast<std::size_t>(align) };
+    // aligned_alloc wants the size to be a multiple of the alignment:
+    if (void* memory { std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) })
+        return memory;
+    throw std::bad_alloc{};
+}
+ALLOC_COUNT_HOOK void* operator new[](std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+ALLOC_COUNT_HOOK void operator delete(void* memory) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete[](void* memory) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+ALLOC_COUNT_HOOK void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+#endif
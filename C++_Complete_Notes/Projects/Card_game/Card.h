@@ -0,0 +1,97 @@
+#ifndef CARD_H
+#define CARD_H
+
+#include <array>
+#include <ostream>
+
+struct Card
+{
+        
+    enum Rank
+    {
+        rank_ace,
+        rank_2,
+        rank_3,
+        rank_4,
+        rank_5,
+        rank_6,
+        rank_7,
+        rank_8,
+        rank_9,
+        rank_10,
+        rank_jack,
+        rank_queen,
+        rank_king,
+
+        maxRank,
+        rank_joker = maxRank // not one of the 13 ranks; only decks with spare cards (see Deck.h) hold jokers
+    };
+    enum Suits
+    {
+        suits_clubs,
+        suits_diamonds,
+        suits_hearts,
+        suits_spades,
+
+        maxSuits
+    };
+
+    constexpr static std::array<Rank,maxRank> allRank { 
+        rank_ace,
+        rank_2,
+        rank_3,
+        rank_4,
+        rank_5,
+        rank_6,
+        rank_7,
+        rank_8,
+        rank_9,
+        rank_10,
+        rank_jack,
+        rank_queen,
+        rank_king
+    };
+    constexpr static std::array<Suits,maxSuits> allSuits {
+        suits_clubs,
+        suits_diamonds,
+        suits_hearts,
+        suits_spades
+    };
+
+    Rank rankCard {};
+    Suits suitCard {};
+
+    friend std::ostream& operator<<(std::ostream& out, const Card &card)
+    {
+        static std::array<char,maxRank + 1> rank { 'A','2','3','4','5','6','7','8','9','T','J','Q','K','*' };
+        static std::array<char,maxSuits> suit {'C','D','H','S'};
+
+        out << rank[card.rankCard] << suit[card.suitCard];
+        return out;
+    }
+    // Jokers carry no value in Black-Jack:
+    int val() const
+    {
+        static constexpr std::array<int,maxRank + 1> rankVal {11,2,3,4,5,6,7,8,9,10,10,10,10,0};
+        return rankVal[rankCard];
+    }
+    constexpr bool isJoker() const { return rankCard == rank_joker; }
+    // Cards in a deck without jokers (Suits and Rank are different enums, so they are multiplied as ints):
+    static constexpr int deckCards { static_cast<int>(maxSuits) * static_cast<int>(maxRank) };
+    // Position of the card in a fresh deck (0-51), used to store cards as a single byte. Jokers follow at 52 and up:
+    constexpr int index() const
+    {
+        const int suit { static_cast<int>(suitCard) };
+        return isJoker() ? deckCards + suit : suit * static_cast<int>(maxRank) + static_cast<int>(rankCard);
+    }
+    static constexpr Card fromIndex(int index)
+    {
+        if (index >= deckCards)
+            return joker(index - deckCards);
+        return Card{ allRank[index % maxRank], allSuits[index / maxRank] };
+    }
+    // The nth joker of a deck; the suit only tells jokers apart, so it prints as *C, *D, ...
+    static constexpr Card joker(int n) { return Card{ rank_joker, allSuits[n % maxSuits] }; }
+};
+
+#endif
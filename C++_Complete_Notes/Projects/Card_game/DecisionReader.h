@@ -0,0 +1,95 @@
+#ifndef DECISION_READER_H
+#define DECISION_READER_H
+
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+
+#include <fcntl.h>  // open
+#include <unistd.h> // read, close
+
+// Reads hit/stand decisions ('h' or 's') from a file or a pipe, so a script or a bot can drive the interactive game.
+// Input is pulled in with large read() calls into one buffer and scanned in place: no iostream extraction and no
+// copies. Like the interactive prompt, anything that isn't a decision (newlines, spaces, comments) is skipped.
+class DecisionReader
+{
+private:
+    int m_fd {-1};
+    bool m_ownsFd {false};
+    std::unique_ptr<char[]> m_buffer;
+    std::size_t m_capacity {};
+    std::size_t m_size {0};
+    std::size_t m_next {0};
+    bool m_ended {false};
+
+    // Refills the buffer once it has been scanned; false at the end of the input.
+    bool refill()
+    {
+        while (!m_ended)
+        {
+            const ssize_t got { ::read(m_fd, m_buffer.get(), m_capacity) };
+            if (got > 0)
+            {
+                m_size = static_cast<std::size_t>(got);
+                m_next = 0;
+                return true;
+            }
+            if (got == 0 || errno != EINTR)
+                m_ended = true;
+        }
+        return false;
+    }
+    static bool isDecision(char c) { return c == 'h' || c == 's'; }
+
+public:
+    // Reads from `path`, or from standard input when the path is "-":
+    explicit DecisionReader(const char* path, std::size_t capacity = 1 << 20)
+        : m_buffer { std::make_unique<char[]>(capacity) }
+        , m_capacity { capacity }
+    {
+        if (path[0] == '-' && path[1] == '\0')
+        {
+            m_fd = STDIN_FILENO;
+        }
+        else
+        {
+            m_fd = ::open(path, O_RDONLY);
+            m_ownsFd = true;
+        }
+        m_ended = m_fd < 0;
+    }
+    ~DecisionReader()
+    {
+        if (m_ownsFd && m_fd >= 0)
+            ::close(m_fd);
+    }
+    DecisionReader(const DecisionReader&) = delete;
+    DecisionReader& operator=(const DecisionReader&) = delete;
+
+    bool isOpen() const { return m_fd >= 0; }
+
+    // True while another decision is waiting, skipping anything else on the way:
+    bool more()
+    {
+        while (true)
+        {
+            while (m_next < m_size)
+            {
+                if (isDecision(m_buffer[m_next]))
+                    return true;
+                ++m_next;
+            }
+            if (!refill())
+                return false;
+        }
+    }
+    // The next decision, or 's' once the input has run out, so a hand cut short just stands:
+    char next()
+    {
+        if (!more())
+            return 's';
+        return m_buffer[m_next++];
+    }
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef DECK_H
+#define DECK_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include "Card.h"
+#include "Random.h"  // for Random::shuffle
+
+// The cards of a deck in their unopened order, worked out at compile time: as many full 52 card decks as fit
+// into N (suit by suit, ace to king), then the rest are jokers. CardT needs fromIndex() and joker(), like Card.
+// N has to hold at least one full deck: jokers only ever fill out the cards past the last full one.
+template <typename CardT, std::size_t N>
+constexpr std::array<CardT,N> canonicalOrder()
+{
+    constexpr std::size_t deckSize { static_cast<std::size_t>(CardT::maxSuits) * static_cast<std::size_t>(CardT::maxRank) };
+    static_assert(N >= deckSize, "A deck needs at least one full set of cards");
+    constexpr std::size_t fullDecks { N / deckSize };
+    std::array<CardT,N> cards {};
+    for (std::size_t index {0}; index < N; ++index)
+    {
+        cards[index] = index < fullDecks * deckSize ? CardT::fromIndex(static_cast<int>(index % deckSize))
+                                                    : CardT::joker(static_cast<int>(index - fullDecks * deckSize));
+    }
+    return cards;
+}
+template <typename CardT, std::size_t N>
+inline constexpr std::array<CardT,N> canonicalDeck { canonicalOrder<CardT,N>() };
+
+// N cards dealt from the top after a shuffle. Building one copies the canonical image, nothing more:
+// Deck<Card,52> is the standard deck, Deck<Card,104> two decks, Deck<Card,54> one deck with two jokers.
+template <typename CardT, std::size_t N>
+class Deck
+{
+private:
+    std::array<CardT,N> m_cards { canonicalDeck<CardT,N> };
+    std::size_t m_nextCardIndex {0};
+public:
+    CardT dealCard()
+    {
+        assert( m_nextCardIndex != N && "Deck Has Gone Through All Cards!" );
+        return m_cards[m_nextCardIndex++];
+    }
+    void shuffle()
+    {
+        Random::shuffle(m_cards.begin(), m_cards.end());
+        m_nextCardIndex = {0};
+    }
+    static constexpr std::size_t size() { return N; }
+};
+
+using StandardDeck = Deck<Card,52>;
+
+#endif
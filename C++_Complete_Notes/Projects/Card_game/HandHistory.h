@@ -0,0 +1,515 @@
+#ifndef HAND_HISTORY_H
+#define HAND_HISTORY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // write, close
+
+#include "MpscQueue.h"
+
+// Hand-history logging.
+// Simulation threads never touch the file: they push fixed-size records into a lock-free queue,
+// and one writer thread drains it, compresses the records block by block and writes them out in big write() calls.
+//
+// File layout (version 2):
+//   FileHeader
+//   blocks: BlockHeader, then the block's varint bytes, then its bit-packed bytes
+//   block index: one BlockIndexEntry per block
+//   FileFooter (at the very end: where the index starts and how many blocks there are)
+// Every block starts from scratch (deltas restart, nothing refers to an earlier block),
+// so the index lets readers decode any block on its own, and many blocks at once.
+namespace History
+{
+    constexpr int maxHandCards {12};
+
+    // Values of HandRecord::result; the same order as the Result enum in main.cpp:
+    enum RecordResult : std::uint8_t
+    {
+        recordTie,
+        recordWin,
+        recordLose,
+
+        maxRecordResult
+    };
+
+    // One seat's hand. Cards are stored as Card::index() values (0-51), so the record is plain data.
+    struct HandRecord
+    {
+        std::uint64_t seed {};     // the seed its shoe was shuffled from
+        std::uint32_t hand {};     // hand number within the shoe
+        std::uint16_t config {};   // which sweep configuration played it
+        std::uint8_t seat {};
+        std::uint8_t result {};    // Result
+        std::uint8_t startTotal {}; // total of the first two cards
+        std::uint8_t soft {};      // 1 if the first two cards made a soft total
+        std::uint8_t finalTotal {};
+        std::uint8_t dealerTotal {};
+        std::uint8_t playerCount {}; // cards in the hand (only the first maxHandCards are kept)
+        std::uint8_t dealerCount {};
+        std::array<std::uint8_t,maxHandCards> playerCards {};
+        std::array<std::uint8_t,maxHandCards> dealerCards {};
+        std::array<std::uint8_t,14> reserved {}; // pads the record to one cache line
+    };
+    static_assert(sizeof(HandRecord) == 64);
+
+    struct FileHeader
+    {
+        std::array<char,8> magic {'B','J','H','I','S','T','\0','\0'};
+        std::uint32_t version {2};
+        std::uint32_t blockRecords {}; // records per block (the last block may hold fewer)
+    };
+    struct BlockHeader
+    {
+        std::uint32_t records {};
+        std::uint32_t varintBytes {};
+        std::uint32_t bitBytes {};
+        std::uint32_t reserved {};
+    };
+    struct BlockIndexEntry
+    {
+        std::uint64_t offset {}; // of the BlockHeader, from the start of the file
+        std::uint32_t records {};
+        std::uint32_t bytes {};  // header included
+    };
+    struct FileFooter
+    {
+        std::uint64_t indexOffset {};
+        std::uint64_t blocks {};
+        std::array<char,8> magic {'B','J','I','N','D','E','X','\0'};
+    };
+
+    // Block encoding:
+    // Varint bytes, per record: hand, seed and config as zigzag deltas from the previous record in the block,
+    // then one byte holding seat (bits 0-2), result (bits 3-4), soft (bit 5) and "same dealer hand as the
+    // previous record" (bit 6), which is the common case with several seats at a table.
+    // Bit-packed bytes, per record: start total, final total (6 bits each), player card count (5 bits),
+    // 6 bits per kept card, then, unless the dealer hand repeats, dealer total, count and cards the same way.
+    constexpr int totalBits {6};
+    constexpr int countBits {5};
+    constexpr int cardBits {6};
+
+    inline std::uint64_t zigzag(std::int64_t value) { return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63); }
+    inline std::int64_t unzigzag(std::uint64_t value) { return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1); }
+
+    inline void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+    inline std::uint64_t getVarint(const std::uint8_t*& in)
+    {
+        std::uint64_t value {0};
+        for (int shift {0}; ; shift += 7)
+        {
+            const std::uint8_t byte { *in++ };
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (byte < 0x80)
+                return value;
+        }
+    }
+
+    class BitWriter
+    {
+    private:
+        std::vector<std::uint8_t>& m_out;
+        std::uint64_t m_bits {0};
+        int m_used {0};
+    public:
+        explicit BitWriter(std::vector<std::uint8_t>& out) : m_out { out } {}
+        void put(std::uint32_t value, int bits)
+        {
+            m_bits |= static_cast<std::uint64_t>(value) << m_used;
+            m_used += bits;
+            while (m_used >= 8)
+            {
+                m_out.push_back(static_cast<std::uint8_t>(m_bits));
+                m_bits >>= 8;
+                m_used -= 8;
+            }
+        }
+        void finish()
+        {
+            if (m_used > 0)
+                m_out.push_back(static_cast<std::uint8_t>(m_bits));
+            m_bits = 0;
+            m_used = 0;
+        }
+    };
+    class BitReader
+    {
+    private:
+        const std::uint8_t* m_in;
+        std::uint64_t m_bits {0};
+        int m_have {0};
+    public:
+        explicit BitReader(const std::uint8_t* in) : m_in { in } {}
+        std::uint32_t get(int bits)
+        {
+            while (m_have < bits)
+            {
+                m_bits |= static_cast<std::uint64_t>(*m_in++) << m_have;
+                m_have += 8;
+            }
+            const auto value { static_cast<std::uint32_t>(m_bits & ((1u << bits) - 1)) };
+            m_bits >>= bits;
+            m_have -= bits;
+            return value;
+        }
+    };
+
+    inline bool sameDealerHand(const HandRecord& a, const HandRecord& b)
+    {
+        return a.seed == b.seed && a.hand == b.hand && a.config == b.config && a.dealerTotal == b.dealerTotal
+            && a.dealerCount == b.dealerCount && a.dealerCards == b.dealerCards;
+    }
+
+    // Appends one encoded block (header included) to `out`.
+    inline void encodeBlock(const HandRecord* records, std::uint32_t count, std::vector<std::uint8_t>& out,
+                            std::vector<std::uint8_t>& varints, std::vector<std::uint8_t>& bits)
+    {
+        varints.clear();
+        bits.clear();
+        BitWriter packer { bits };
+        HandRecord previous {};
+        for (std::uint32_t i {0}; i < count; ++i)
+        {
+            const HandRecord& record { records[i] };
+            const bool sameDealer { i > 0 && sameDealerHand(record, previous) };
+            putVarint(varints, zigzag(static_cast<std::int64_t>(record.hand) - static_cast<std::int64_t>(previous.hand)));
+            putVarint(varints, zigzag(static_cast<std::int64_t>(record.seed - previous.seed)));
+            putVarint(varints, zigzag(static_cast<std::int64_t>(record.config) - static_cast<std::int64_t>(previous.config)));
+            varints.push_back(static_cast<std::uint8_t>((record.seat & 7) | (record.result & 3) << 3
+                                                        | (record.soft & 1) << 5 | sameDealer << 6));
+
+            packer.put(record.startTotal, totalBits);
+            packer.put(record.finalTotal, totalBits);
+            packer.put(std::min<std::uint32_t>(record.playerCount, 31), countBits);
+            for (int card {0}; card < std::min<int>(record.playerCount, maxHandCards); ++card)
+                packer.put(record.playerCards[card], cardBits);
+            if (!sameDealer)
+            {
+                packer.put(record.dealerTotal, totalBits);
+                packer.put(std::min<std::uint32_t>(record.dealerCount, 31), countBits);
+                for (int card {0}; card < std::min<int>(record.dealerCount, maxHandCards); ++card)
+                    packer.put(record.dealerCards[card], cardBits);
+            }
+            previous = record;
+        }
+        packer.finish();
+
+        const BlockHeader header { count, static_cast<std::uint32_t>(varints.size()), static_cast<std::uint32_t>(bits.size()), 0 };
+        const auto* headerBytes { reinterpret_cast<const std::uint8_t*>(&header) };
+        out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+        out.insert(out.end(), varints.begin(), varints.end());
+        out.insert(out.end(), bits.begin(), bits.end());
+    }
+
+    // Decodes the block starting at `block` (its BlockHeader) into `out`, which must hold header.records records.
+    inline void decodeBlock(const std::uint8_t* block, HandRecord* out)
+    {
+        BlockHeader header {};
+        std::memcpy(&header, block, sizeof(header));
+        const std::uint8_t* varints { block + sizeof(header) };
+        BitReader unpacker { varints + header.varintBytes };
+        HandRecord previous {};
+        for (std::uint32_t i {0}; i < header.records; ++i)
+        {
+            HandRecord record {};
+            record.hand = static_cast<std::uint32_t>(previous.hand + unzigzag(getVarint(varints)));
+            record.seed = previous.seed + static_cast<std::uint64_t>(unzigzag(getVarint(varints)));
+            record.config = static_cast<std::uint16_t>(previous.config + unzigzag(getVarint(varints)));
+            const std::uint8_t flags { *varints++ };
+            record.seat = flags & 7;
+            record.result = (flags >> 3) & 3;
+            record.soft = (flags >> 5) & 1;
+
+            record.startTotal = static_cast<std::uint8_t>(unpacker.get(totalBits));
+            record.finalTotal = static_cast<std::uint8_t>(unpacker.get(totalBits));
+            record.playerCount = static_cast<std::uint8_t>(unpacker.get(countBits));
+            for (int card {0}; card < std::min<int>(record.playerCount, maxHandCards); ++card)
+                record.playerCards[card] = static_cast<std::uint8_t>(unpacker.get(cardBits));
+            if (flags & 0x40)
+            {
+                record.dealerTotal = previous.dealerTotal;
+                record.dealerCount = previous.dealerCount;
+                record.dealerCards = previous.dealerCards;
+            }
+            else
+            {
+                record.dealerTotal = static_cast<std::uint8_t>(unpacker.get(totalBits));
+                record.dealerCount = static_cast<std::uint8_t>(unpacker.get(countBits));
+                for (int card {0}; card < std::min<int>(record.dealerCount, maxHandCards); ++card)
+                    record.dealerCards[card] = static_cast<std::uint8_t>(unpacker.get(cardBits));
+            }
+            out[i] = record;
+            previous = record;
+        }
+    }
+
+    // Owns the record queue and the thread that compresses and writes it out.
+    class Writer
+    {
+    private:
+        MpscQueue<HandRecord> m_queue;
+        bool m_dropWhenFull {};
+        int m_fd {-1};
+        std::uint64_t m_offset {0};          // bytes written so far
+        std::vector<HandRecord> m_block {};  // records waiting for the current block
+        std::size_t m_blockFill {0};
+        std::vector<std::uint8_t> m_out {};  // encoded blocks waiting for the next write()
+        std::vector<std::uint8_t> m_varints {};
+        std::vector<std::uint8_t> m_bits {};
+        std::vector<BlockIndexEntry> m_index {};
+        std::uint64_t m_written {0};         // records in blocks that made it to the file
+        std::uint64_t m_unflushed {0};       // records in the blocks waiting in m_out
+        std::uint64_t m_lost {0};            // records that were queued but are not in a readable file
+        int m_error {0};                     // errno of the first failed write, 0 while all is well
+        std::uint64_t m_writeCalls {0};
+        std::atomic<bool> m_stopping {false};
+        std::thread m_thread {};
+
+        static constexpr std::size_t writeBytes { 1 << 20 };
+
+        // Once a write has failed (disk full or similar) nothing more is written: the block offsets in the index
+        // would no longer match the file.
+        bool writeOut(const void* bytes, std::size_t size)
+        {
+            const char* data { static_cast<const char*>(bytes) };
+            while (size > 0 && m_error == 0)
+            {
+                const ssize_t done { ::write(m_fd, data, size) };
+                if (done < 0 && errno == EINTR)
+                    continue;
+                if (done <= 0)
+                {
+                    m_error = done < 0 ? errno : ENOSPC;
+                    break;
+                }
+                data += done;
+                size -= static_cast<std::size_t>(done);
+                m_offset += static_cast<std::uint64_t>(done);
+                ++m_writeCalls;
+            }
+            return m_error == 0;
+        }
+        void endBlock()
+        {
+            if (m_blockFill == 0)
+                return;
+            const std::size_t start { m_out.size() };
+            encodeBlock(m_block.data(), static_cast<std::uint32_t>(m_blockFill), m_out, m_varints, m_bits);
+            m_index.push_back({ m_offset + start, static_cast<std::uint32_t>(m_blockFill), static_cast<std::uint32_t>(m_out.size() - start) });
+            m_unflushed += m_blockFill;
+            m_blockFill = 0;
+            if (m_out.size() >= writeBytes)
+                flush();
+        }
+        void flush()
+        {
+            if (writeOut(m_out.data(), m_out.size()))
+                m_written += m_unflushed;
+            else
+                m_lost += m_unflushed;
+            m_unflushed = 0;
+            m_out.clear();
+        }
+        void run()
+        {
+            while (true)
+            {
+                m_queue.sampleOccupancy();
+                // Checked before draining, so everything pushed before stop() is still written:
+                const bool stopping { m_stopping.load(std::memory_order_acquire) };
+                bool any {false};
+                while (m_queue.tryPop(m_block[m_blockFill]))
+                {
+                    any = true;
+                    if (++m_blockFill == m_block.size())
+                        endBlock();
+                }
+                if (stopping)
+                    break;
+                if (!any)
+                    std::this_thread::sleep_for(std::chrono::microseconds{200});
+            }
+            endBlock();
+            // The index is padded to an 8 byte boundary, so readers can use it straight from a mapping:
+            m_out.resize(m_out.size() + (8 - (m_offset + m_out.size()) % 8) % 8, 0);
+            flush();
+            const FileFooter footer { m_offset, m_index.size() };
+            if (!writeOut(m_index.data(), m_index.size() * sizeof(BlockIndexEntry)) || !writeOut(&footer, sizeof(footer)))
+            {
+                // Without its index the file can't be read at all:
+                m_lost += m_written;
+                m_written = 0;
+            }
+        }
+
+    public:
+        // `capacity` is the queue size in records (a power of two); `blockRecords` is how many records go in a block.
+        Writer(const std::string& path, std::size_t capacity, bool dropWhenFull, std::uint32_t blockRecords = 4096)
+            : m_queue { capacity }
+            , m_dropWhenFull { dropWhenFull }
+            , m_block( blockRecords )
+        {
+            m_out.reserve(writeBytes + blockRecords * sizeof(HandRecord));
+            m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (m_fd < 0)
+                return;
+            FileHeader header {};
+            header.blockRecords = blockRecords;
+            writeOut(&header, sizeof(header));
+            if (m_offset != sizeof(header))
+            {
+                ::close(m_fd);
+                m_fd = -1;
+                return;
+            }
+            m_thread = std::thread{ [this]() { run(); } };
+        }
+        ~Writer() { stop(); }
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool isOpen() const { return m_fd >= 0; }
+
+        // Called by simulation threads; never blocks on the file.
+        void record(const HandRecord& record)
+        {
+            if (m_dropWhenFull)
+                m_queue.pushOrDrop(record);
+            else
+                m_queue.push(record);
+        }
+        // Writes out everything queued so far, then the block index, and closes the file.
+        void stop()
+        {
+            if (m_thread.joinable())
+            {
+                m_stopping.store(true, std::memory_order_release);
+                m_thread.join();
+            }
+            if (m_fd >= 0)
+            {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+        }
+
+        std::uint64_t written() const { return m_written; }
+        std::uint64_t lost() const { return m_lost; }
+        // The errno of the write that failed, or 0 if the whole file was written:
+        int error() const { return m_error; }
+        std::uint64_t writeCalls() const { return m_writeCalls; }
+        std::uint64_t bytes() const { return m_offset; }
+        const MpscQueue<HandRecord>& queue() const { return m_queue; }
+    };
+
+    // A history file mapped read-only, with its block index.
+    class Reader
+    {
+    private:
+        const std::uint8_t* m_data {nullptr};
+        std::size_t m_size {0};
+        const BlockIndexEntry* m_index {nullptr};
+        std::size_t m_blocks {0};
+        std::uint64_t m_records {0};
+        std::uint32_t m_blockRecords {0};
+    public:
+        explicit Reader(const std::string& path)
+        {
+            const int fd { ::open(path.c_str(), O_RDONLY) };
+            if (fd < 0)
+                return;
+            struct stat info {};
+            if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(FileHeader) + sizeof(FileFooter))
+            {
+                m_size = static_cast<std::size_t>(info.st_size);
+                void* mapping { ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+                if (mapping != MAP_FAILED)
+                    m_data = static_cast<const std::uint8_t*>(mapping);
+            }
+            ::close(fd);
+            if (!m_data)
+                return;
+
+            FileHeader header {};
+            FileFooter footer {};
+            std::memcpy(&header, m_data, sizeof(header));
+            std::memcpy(&footer, m_data + m_size - sizeof(footer), sizeof(footer));
+            bool valid { header.magic == FileHeader{}.magic && header.version == FileHeader{}.version
+                         && footer.magic == FileFooter{}.magic && footer.blocks <= m_size / sizeof(BlockIndexEntry)
+                         && footer.indexOffset % alignof(BlockIndexEntry) == 0
+                         && footer.indexOffset + footer.blocks * sizeof(BlockIndexEntry) + sizeof(footer) == m_size };
+            if (valid)
+            {
+                m_index = reinterpret_cast<const BlockIndexEntry*>(m_data + footer.indexOffset);
+                m_blocks = footer.blocks;
+                m_blockRecords = header.blockRecords;
+            }
+            // Every block has to lie between the file header and the index, and agree with its own header,
+            // before anything decodes it:
+            for (std::size_t block {0}; valid && block < m_blocks; ++block)
+            {
+                const BlockIndexEntry& entry { m_index[block] };
+                BlockHeader blockHeader {};
+                valid = entry.offset >= sizeof(FileHeader) && entry.bytes >= sizeof(BlockHeader)
+                        && entry.offset <= footer.indexOffset && entry.bytes <= footer.indexOffset - entry.offset;
+                if (valid)
+                {
+                    std::memcpy(&blockHeader, m_data + entry.offset, sizeof(blockHeader));
+                    valid = blockHeader.records == entry.records && blockHeader.records <= m_blockRecords
+                            && sizeof(BlockHeader) + std::uint64_t{blockHeader.varintBytes} + blockHeader.bitBytes == entry.bytes;
+                }
+                m_records += entry.records;
+            }
+            if (!valid)
+            {
+                ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+                m_data = nullptr;
+                m_index = nullptr;
+                m_blocks = 0;
+                m_records = 0;
+            }
+        }
+        ~Reader()
+        {
+            if (m_data)
+                ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        bool isOpen() const { return m_data != nullptr; }
+        std::size_t blocks() const { return m_blocks; }
+        std::uint64_t records() const { return m_records; }
+        std::uint32_t blockRecords() const { return m_blockRecords; }
+        std::size_t bytes() const { return m_size; }
+        const BlockIndexEntry& block(std::size_t index) const { return m_index[index]; }
+
+        // Safe to call from several threads at once, one block each.
+        void decode(std::size_t index, std::vector<HandRecord>& out) const
+        {
+            out.resize(m_index[index].records);
+            decodeBlock(m_data + m_index[index].offset, out.data());
+        }
+    };
+}
+
+#endif
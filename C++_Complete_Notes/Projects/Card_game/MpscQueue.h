@@ -0,0 +1,129 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// A bounded, lock-free multi-producer/single-consumer ring buffer.
+// Every slot carries a sequence number saying whose turn it is: producers claim a position with one
+// compare-and-swap on the head, fill the slot, then publish it by bumping the slot's sequence.
+// The single consumer reads slots in order and hands each one back to producers a lap later.
+// The capacity must be a power of two, so a position maps to a slot with a mask instead of a division.
+template <typename T>
+class MpscQueue
+{
+private:
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence {};
+        T value {};
+    };
+
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // Producer and consumer positions live on separate cache lines, so they don't slow each other down:
+    alignas(64) std::atomic<std::size_t> m_head {0};
+    alignas(64) std::atomic<std::size_t> m_tail {0};
+    alignas(64) std::atomic<std::uint64_t> m_dropped {0};
+    std::atomic<std::uint64_t> m_stalls {0};
+    std::atomic<std::size_t> m_highWater {0};
+
+    void noteOccupancy(std::size_t occupancy)
+    {
+        std::size_t seen { m_highWater.load(std::memory_order_relaxed) };
+        while (occupancy > seen && !m_highWater.compare_exchange_weak(seen, occupancy, std::memory_order_relaxed))
+        {
+        }
+    }
+
+public:
+    explicit MpscQueue(std::size_t capacity)
+        : m_capacity { capacity }
+        , m_mask { capacity - 1 }
+        , m_slots { std::make_unique<Slot[]>(capacity) }
+    {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0 && "MpscQueue capacity must be a power of two");
+        for (std::size_t i {0}; i < capacity; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Adds a value, or returns false straight away when the queue is full.
+    bool tryPush(const T& value)
+    {
+        std::size_t position { m_head.load(std::memory_order_relaxed) };
+        while (true)
+        {
+            Slot& slot { m_slots[position & m_mask] };
+            const std::size_t sequence { slot.sequence.load(std::memory_order_acquire) };
+            const auto lag { static_cast<std::ptrdiff_t>(sequence - position) };
+            if (lag == 0)
+            {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                noteOccupancy(m_capacity);
+                return false; // the consumer hasn't freed this slot yet
+            }
+            else
+            {
+                position = m_head.load(std::memory_order_relaxed); // another producer took it, try the next one
+            }
+        }
+    }
+    // Adds a value, dropping it (and counting the drop) when the queue is full.
+    bool pushOrDrop(const T& value)
+    {
+        if (tryPush(value))
+            return true;
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // Adds a value, waiting for the consumer when the queue is full. Each wait is counted as a stall.
+    void push(const T& value)
+    {
+        if (tryPush(value))
+            return;
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+        while (!tryPush(value))
+            std::this_thread::yield();
+    }
+
+    // Consumer only: takes the oldest value, or returns false when the queue is empty.
+    bool tryPop(T& value)
+    {
+        const std::size_t position { m_tail.load(std::memory_order_relaxed) };
+        Slot& slot { m_slots[position & m_mask] };
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+        value = slot.value;
+        slot.sequence.store(position + m_capacity, std::memory_order_release);
+        m_tail.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+    // Consumer only: samples how full the queue is, for the high-water mark.
+    void sampleOccupancy()
+    {
+        const std::size_t tail { m_tail.load(std::memory_order_relaxed) };
+        const std::size_t head { m_head.load(std::memory_order_relaxed) };
+        noteOccupancy(head - tail);
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    std::uint64_t stalls() const { return m_stalls.load(std::memory_order_relaxed); }
+    std::size_t highWater() const { return m_highWater.load(std::memory_order_relaxed); }
+};
+
+#endif
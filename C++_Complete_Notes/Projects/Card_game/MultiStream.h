@@ -0,0 +1,219 @@
+#ifndef MULTI_STREAM_H
+#define MULTI_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <immintrin.h> // AVX2 and AVX-512 intrinsics, only used on CPUs that have them
+#include "Random.h"
+
+// xoshiro256** run as 16 independent streams side by side, so one step of the generator is a handful of vector
+// instructions over all 16 instead of 16 trips through the scalar code. The state is kept lane by lane
+// (every stream's first word together, then every stream's second word, ...), which is what the vector code loads.
+//
+// The step comes in a plain version, an AVX2 version (4 streams per register) and an AVX-512 version (8 per register),
+// picked once at startup from what the CPU has, like the bitmap loops in query.cpp. All three produce exactly the
+// same numbers, so a seeded run gives the same results on every host.
+//
+// It is a uniform random bit generator like the engines in Random.h, handing out its numbers from a small buffer,
+// and it also has generateBits() for whole blocks at a time, which Random::fill uses when it finds it.
+namespace MultiStream
+{
+    constexpr int lanes {16};
+    using State = std::array<std::array<std::uint64_t,lanes>,4>; // [word][lane]
+
+    // Steps every stream `blocks` times, writing block b's numbers to out[b * lanes, (b + 1) * lanes):
+    inline std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    inline void stepScalar(State& state, std::uint64_t* out, std::size_t blocks)
+    {
+        auto& [s0, s1, s2, s3] { state };
+        for (std::size_t block {0}; block < blocks; ++block)
+        {
+            for (int lane {0}; lane < lanes; ++lane)
+            {
+                out[block * lanes + lane] = rotl(s1[lane] * 5, 7) * 9;
+                const std::uint64_t t { s1[lane] << 17 };
+                s2[lane] ^= s0[lane];
+                s3[lane] ^= s1[lane];
+                s1[lane] ^= s2[lane];
+                s0[lane] ^= s3[lane];
+                s2[lane] ^= t;
+                s3[lane] = rotl(s3[lane], 45);
+            }
+        }
+    }
+
+    __attribute__((target("avx2"))) inline __m256i rotlAvx2(__m256i x, int k)
+    {
+        return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+    }
+    __attribute__((target("avx2"))) inline void stepAvx2(State& state, std::uint64_t* out, std::size_t blocks)
+    {
+        constexpr int groups { lanes / 4 };
+        __m256i s[4][groups];
+        for (int word {0}; word < 4; ++word)
+            for (int group {0}; group < groups; ++group)
+                s[word][group] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[word].data() + group * 4));
+
+        for (std::size_t block {0}; block < blocks; ++block)
+        {
+            for (int group {0}; group < groups; ++group)
+            {
+                __m256i& s0 { s[0][group] };
+                __m256i& s1 { s[1][group] };
+                __m256i& s2 { s[2][group] };
+                __m256i& s3 { s[3][group] };
+                // No 64-bit multiply in AVX2: x * 5 is (x << 2) + x and x * 9 is (x << 3) + x.
+                const __m256i times5 { _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1) };
+                const __m256i rotated { rotlAvx2(times5, 7) };
+                const __m256i result { _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated) };
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + block * lanes + group * 4), result);
+
+                const __m256i t { _mm256_slli_epi64(s1, 17) };
+                s2 = _mm256_xor_si256(s2, s0);
+                s3 = _mm256_xor_si256(s3, s1);
+                s1 = _mm256_xor_si256(s1, s2);
+                s0 = _mm256_xor_si256(s0, s3);
+                s2 = _mm256_xor_si256(s2, t);
+                s3 = rotlAvx2(s3, 45);
+            }
+        }
+
+        for (int word {0}; word < 4; ++word)
+            for (int group {0}; group < groups; ++group)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[word].data() + group * 4), s[word][group]);
+    }
+
+    __attribute__((target("avx512f"))) inline void stepAvx512(State& state, std::uint64_t* out, std::size_t blocks)
+    {
+        constexpr int groups { lanes / 8 };
+        // The zero-masked forms with every lane selected: GCC 12 warns about the unmasked shifts and rotates.
+        constexpr __mmask8 all {0xff};
+        __m512i s[4][groups];
+        for (int word {0}; word < 4; ++word)
+            for (int group {0}; group < groups; ++group)
+                s[word][group] = _mm512_loadu_si512(state[word].data() + group * 8);
+
+        for (std::size_t block {0}; block < blocks; ++block)
+        {
+            for (int group {0}; group < groups; ++group)
+            {
+                __m512i& s0 { s[0][group] };
+                __m512i& s1 { s[1][group] };
+                __m512i& s2 { s[2][group] };
+                __m512i& s3 { s[3][group] };
+                const __m512i times5 { _mm512_add_epi64(_mm512_maskz_slli_epi64(all, s1, 2), s1) };
+                const __m512i rotated { _mm512_maskz_rol_epi64(all, times5, 7) };
+                const __m512i result { _mm512_add_epi64(_mm512_maskz_slli_epi64(all, rotated, 3), rotated) };
+                _mm512_storeu_si512(out + block * lanes + group * 8, result);
+
+                const __m512i t { _mm512_maskz_slli_epi64(all, s1, 17) };
+                s2 = _mm512_xor_si512(s2, s0);
+                s3 = _mm512_xor_si512(s3, s1);
+                s1 = _mm512_xor_si512(s1, s2);
+                s0 = _mm512_xor_si512(s0, s3);
+                s2 = _mm512_xor_si512(s2, t);
+                s3 = _mm512_maskz_rol_epi64(all, s3, 45);
+            }
+        }
+
+        for (int word {0}; word < 4; ++word)
+            for (int group {0}; group < groups; ++group)
+                _mm512_storeu_si512(state[word].data() + group * 8, s[word][group]);
+    }
+
+    struct Kernel
+    {
+        void (*step)(State&, std::uint64_t*, std::size_t);
+        const char* name;
+    };
+    inline Kernel pick()
+    {
+        if (__builtin_cpu_supports("avx512f"))
+            return { stepAvx512, "AVX-512" };
+        if (__builtin_cpu_supports("avx2"))
+            return { stepAvx2, "AVX2" };
+        return { stepScalar, "scalar" };
+    }
+    // Picked on first use rather than before main:
+    inline const Kernel& kernel()
+    {
+        static const Kernel picked { pick() };
+        return picked;
+    }
+
+    class Xoshiro256x16
+    {
+    private:
+        static constexpr std::size_t bufferBlocks {4};
+        State m_state {};
+        std::array<std::uint64_t,bufferBlocks * lanes> m_buffer {};
+        std::size_t m_next { m_buffer.size() };
+        void (*m_step)(State&, std::uint64_t*, std::size_t) { kernel().step };
+
+    public:
+        using result_type = std::uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type{0}; }
+
+        Xoshiro256x16() { std::seed_seq ss {}; seed(ss); }
+        explicit Xoshiro256x16(std::seed_seq& ss) { seed(ss); }
+        // One xoshiro256** is seeded, and every stream after the first starts a jump() (2^128 numbers) further on,
+        // so the 16 streams can never overlap:
+        void seed(std::seed_seq& ss)
+        {
+            Random::Xoshiro256StarStar stream { ss };
+            for (int lane {0}; lane < lanes; ++lane)
+            {
+                for (int word {0}; word < 4; ++word)
+                    m_state[word][lane] = stream.state()[word];
+                stream.jump();
+            }
+            m_next = m_buffer.size();
+        }
+        // A child generator that takes the next 2^192 numbers of every stream, while this one long-jumps past them.
+        // Numbers already in the buffer stay with the parent.
+        Xoshiro256x16 split()
+        {
+            Xoshiro256x16 child { *this };
+            child.m_next = m_buffer.size();
+            for (int lane {0}; lane < lanes; ++lane)
+            {
+                Random::Xoshiro256StarStar stream { { m_state[0][lane], m_state[1][lane], m_state[2][lane], m_state[3][lane] } };
+                stream.longJump();
+                for (int word {0}; word < 4; ++word)
+                    m_state[word][lane] = stream.state()[word];
+            }
+            return child;
+        }
+        // Uses the plain step whatever the CPU has, to check the vector versions against it:
+        void forceScalar() { m_step = stepScalar; }
+
+        result_type operator()()
+        {
+            if (m_next == m_buffer.size())
+            {
+                m_step(m_state, m_buffer.data(), bufferBlocks);
+                m_next = 0;
+            }
+            return m_buffer[m_next++];
+        }
+        // Fills out[0, count) with the next count numbers, whole blocks straight from the vector step:
+        void generateBits(std::uint64_t* out, std::size_t count)
+        {
+            while (count > 0 && m_next < m_buffer.size())
+            {
+                *out++ = m_buffer[m_next++];
+                --count;
+            }
+            const std::size_t blocks { count / lanes };
+            m_step(m_state, out, blocks);
+            for (std::size_t i { blocks * lanes }; i < count; ++i)
+                out[i] = (*this)();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,279 @@
+#ifndef POKER_H
+#define POKER_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "Card.h"
+
+// Poker hand evaluation for 5 to 7 cards.
+// A hand is one 64-bit word holding a 13-bit rank mask per suit (bit 0 = deuce ... bit 12 = ace), so adding a card
+// is a single OR and a hand never needs sorting. Evaluation finds flushes by counting all four suits at once and
+// looks up straights and the best kickers in 8192-entry tables indexed by a rank mask. Every other hand is scored by
+// its multiset of ranks alone, which is looked up in a table built at startup. The score is one integer: a higher
+// score is a better hand and equal scores split the pot.
+namespace Poker
+{
+    using Hand = std::uint64_t;
+    using Score = std::uint32_t;
+
+    enum Category
+    {
+        highCard,
+        onePair,
+        twoPair,
+        threeOfAKind,
+        straight,
+        flush,
+        fullHouse,
+        fourOfAKind,
+        straightFlush,
+
+        maxCategory
+    };
+    constexpr std::array<std::string_view,maxCategory> categoryName {
+        "high card", "one pair", "two pair", "three of a kind", "straight", "flush", "full house", "four of a kind",
+        "straight flush"
+    };
+
+    // Card::Rank counts from the ace, but in poker the ace ranks above the king:
+    constexpr int rankBit(Card::Rank rank) { return rank == Card::rank_ace ? 12 : rank - 1; }
+    constexpr Hand cardMask(Card card) { return Hand{1} << (16 * card.suitCard + rankBit(card.rankCard)); }
+
+    // One mask per Card::index(), so cards stored as bytes go straight into a hand:
+    constexpr std::array<Hand,52> makeCardMasks()
+    {
+        std::array<Hand,52> masks {};
+        for (int index {0}; index < 52; ++index)
+            masks[index] = cardMask(Card::fromIndex(index));
+        return masks;
+    }
+    inline constexpr std::array<Hand,52> cardMasks { makeCardMasks() };
+
+    constexpr int rankMasks {1 << 13};
+
+    // Top card of the best straight in a rank mask plus one, or 0 for no straight. A5432 counts as five high.
+    constexpr std::array<std::uint8_t,rankMasks> makeStraights()
+    {
+        std::array<std::uint8_t,rankMasks> straights {};
+        for (int mask {0}; mask < rankMasks; ++mask)
+        {
+            for (int high {12}; high >= 4; --high)
+            {
+                const int window { 0x1F << (high - 4) };
+                if ((mask & window) == window)
+                {
+                    straights[mask] = static_cast<std::uint8_t>(high + 1);
+                    break;
+                }
+            }
+            constexpr int wheel { 0x100F }; // ace, five, four, three, deuce
+            if (straights[mask] == 0 && (mask & wheel) == wheel)
+                straights[mask] = 3 + 1;
+        }
+        return straights;
+    }
+    // The five highest ranks in a rank mask as 4-bit fields, highest first (bits 16-19 down to bits 0-3).
+    // Shifting right by 4 * (5 - n) leaves the top n ranks.
+    constexpr std::array<std::uint32_t,rankMasks> makeTopRanks()
+    {
+        std::array<std::uint32_t,rankMasks> tops {};
+        for (int mask {0}; mask < rankMasks; ++mask)
+        {
+            std::uint32_t top {0};
+            int taken {0};
+            for (int rank {12}; rank >= 0 && taken < 5; --rank)
+            {
+                if (mask & (1 << rank))
+                {
+                    top |= static_cast<std::uint32_t>(rank) << (4 * (4 - taken));
+                    ++taken;
+                }
+            }
+            tops[mask] = top;
+        }
+        return tops;
+    }
+    inline constexpr std::array<std::uint8_t,rankMasks> straights { makeStraights() };
+    inline constexpr std::array<std::uint32_t,rankMasks> topRanks { makeTopRanks() };
+
+    inline Score score(Category category, std::uint32_t ranks) { return (static_cast<Score>(category) << 20) | ranks; }
+    inline Category category(Score score) { return static_cast<Category>(score >> 20); }
+
+    inline int topRank(unsigned mask) { return 31 - __builtin_clz(mask); }
+
+    // Scores a hand with no flush in it from its ranks alone: pairs, trips and quads come from adding the
+    // suit masks bit by bit, straights and kickers from the rank mask tables.
+    inline Score evaluateRanks(Hand hand)
+    {
+        const unsigned clubs { static_cast<unsigned>(hand) & 0x1FFF };
+        const unsigned diamonds { static_cast<unsigned>(hand >> 16) & 0x1FFF };
+        const unsigned hearts { static_cast<unsigned>(hand >> 32) & 0x1FFF };
+        const unsigned spades { static_cast<unsigned>(hand >> 48) & 0x1FFF };
+        const unsigned ranks { clubs | diamonds | hearts | spades };
+        // How many suits hold each rank, added up bit by bit: a rank held twice sets exactly one carry,
+        // three times one carry plus the low bit, four times two carries.
+        const unsigned carryA { clubs & diamonds };
+        const unsigned sumA { clubs ^ diamonds };
+        const unsigned carryB { sumA & hearts };
+        const unsigned sumB { sumA ^ hearts };
+        const unsigned carryC { sumB & spades };
+        const unsigned odd { sumB ^ spades };
+        const unsigned oneCarry { carryA ^ carryB ^ carryC };
+        const unsigned four { (carryA & carryB) | (carryA & carryC) | (carryB & carryC) };
+        const unsigned threePlus { (oneCarry & odd) | four };
+        if (four)
+        {
+            const int quad { topRank(four) };
+            return score(fourOfAKind, (quad << 16) | (topRank(ranks & ~(1u << quad)) << 12));
+        }
+        const unsigned pairs { oneCarry & ~odd };
+        if (threePlus)
+        {
+            const int trips { topRank(threePlus) };
+            const unsigned rest { (threePlus & ~(1u << trips)) | pairs };
+            if (rest)
+                return score(fullHouse, (trips << 16) | (topRank(rest) << 12));
+        }
+        if (straights[ranks])
+            return score(straight, straights[ranks]);
+        if (threePlus)
+        {
+            const int trips { topRank(threePlus) };
+            return score(threeOfAKind, (trips << 16) | ((topRanks[ranks & ~(1u << trips)] >> 12) << 8));
+        }
+        if (pairs & (pairs - 1)) // two pairs or more
+        {
+            const int high { topRank(pairs) };
+            const int low { topRank(pairs & ~(1u << high)) };
+            const unsigned kickers { ranks & ~(1u << high) & ~(1u << low) };
+            return score(twoPair, (high << 16) | (low << 12) | (topRank(kickers) << 8));
+        }
+        if (pairs)
+        {
+            const int pair { topRank(pairs) };
+            return score(onePair, (pair << 16) | ((topRanks[ranks & ~(1u << pair)] >> 8) << 4));
+        }
+        return score(highCard, topRanks[ranks]);
+    }
+
+    // Every rank held n times adds n * 5^rank, so the sum over the four suits names the multiset of ranks in a hand.
+    constexpr std::array<std::uint32_t,rankMasks> makeRankKeys()
+    {
+        std::array<std::uint32_t,rankMasks> keys {};
+        for (int mask {0}; mask < rankMasks; ++mask)
+        {
+            std::uint32_t power {1};
+            for (int rank {0}; rank < 13; ++rank, power *= 5)
+            {
+                if (mask & (1 << rank))
+                    keys[mask] += power;
+            }
+        }
+        return keys;
+    }
+    inline constexpr std::array<std::uint32_t,rankMasks> rankKeys { makeRankKeys() };
+
+    // The score of every multiset of up to 7 ranks (76,155 of them, with at most 4 of a rank), found by rank key
+    // through a perfect hash: the key picks a bucket, the bucket's displacement moves its keys to free slots, so a
+    // lookup is two loads and never probes. Built once at startup with evaluateRanks().
+    class RankTable
+    {
+    private:
+        static constexpr int slotBits {17};
+        static constexpr int bucketBits {15};
+        std::vector<std::uint16_t> m_displacements;
+        std::vector<Score> m_scores;
+
+        static std::uint64_t mix(std::uint32_t key) { return key * 0x9E3779B97F4A7C15; }
+        static std::size_t bucketFor(std::uint32_t key) { return mix(key) >> (64 - bucketBits); }
+        static std::size_t slotFor(std::uint32_t key, std::uint16_t displacement)
+        {
+            return ((mix(key) ^ displacement * 0xC2B2AE3D27D4EB4F) * 0x165667B19E3779F9) >> (64 - slotBits);
+        }
+
+        // Calls visit(key, hand) for every multiset of up to 7 ranks, dealt out across the suits so none has five cards:
+        template <typename Visit>
+        static void forEachRanks(int rank, int cards, std::uint32_t key, std::uint32_t power, Hand hand, const Visit& visit)
+        {
+            if (rank == 13)
+            {
+                visit(key, hand);
+                return;
+            }
+            for (int count {0}; count <= 4 && cards + count <= 7; ++count)
+            {
+                Hand withRank { hand };
+                for (int card { cards }; card < cards + count; ++card)
+                    withRank |= Hand{1} << (16 * (card % 4) + rank);
+                forEachRanks(rank + 1, cards + count, key + static_cast<std::uint32_t>(count) * power, power * 5, withRank, visit);
+            }
+        }
+    public:
+        RankTable() : m_displacements( std::size_t{1} << bucketBits ), m_scores( std::size_t{1} << slotBits )
+        {
+            std::vector<std::vector<std::pair<std::uint32_t,Score>>> buckets( m_displacements.size() );
+            forEachRanks(0, 0, 0, 1, 0, [&](std::uint32_t key, Hand hand) {
+                buckets[bucketFor(key)].emplace_back(key, evaluateRanks(hand));
+            });
+            // Place the fullest buckets first, each at the first displacement where all its keys land on free slots:
+            std::vector<std::size_t> order( buckets.size() );
+            for (std::size_t bucket {0}; bucket < order.size(); ++bucket)
+                order[bucket] = bucket;
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return buckets[a].size() > buckets[b].size(); });
+            std::vector<bool> taken( m_scores.size() );
+            for (std::size_t bucket : order)
+            {
+                for (std::uint32_t displacement {0};; ++displacement)
+                {
+                    bool fits {true};
+                    for (std::size_t i {0}; fits && i < buckets[bucket].size(); ++i)
+                    {
+                        const std::size_t slot { slotFor(buckets[bucket][i].first, static_cast<std::uint16_t>(displacement)) };
+                        fits = !taken[slot];
+                        for (std::size_t j {0}; fits && j < i; ++j)
+                            fits = slot != slotFor(buckets[bucket][j].first, static_cast<std::uint16_t>(displacement));
+                    }
+                    if (!fits)
+                        continue;
+                    m_displacements[bucket] = static_cast<std::uint16_t>(displacement);
+                    for (const auto& [key, score] : buckets[bucket])
+                    {
+                        taken[slotFor(key, m_displacements[bucket])] = true;
+                        m_scores[slotFor(key, m_displacements[bucket])] = score;
+                    }
+                    break;
+                }
+            }
+        }
+        Score find(std::uint32_t key) const { return m_scores[slotFor(key, m_displacements[bucketFor(key)])]; }
+    };
+    inline const RankTable rankTable {};
+
+    // Scores the best five-card hand in 5 to 7 cards. With at most 7 cards a flush rules out quads and
+    // full houses, so the flush test can come first; every other hand is scored by the table.
+    inline Score evaluate(Hand hand)
+    {
+        // Count the cards in every suit at once, one 16-bit lane per suit, then add 11 to each count:
+        // a lane reaches 16 exactly when its suit has five or more cards.
+        Hand counts { hand - ((hand >> 1) & 0x5555555555555555) };
+        counts = (counts & 0x3333333333333333) + ((counts >> 2) & 0x3333333333333333);
+        counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0F;
+        counts = (counts + (counts >> 8)) & 0x00FF00FF00FF00FF;
+        const Hand flushLanes { (counts + 0x000B000B000B000B) & 0x0010001000100010 };
+        if (flushLanes)
+        {
+            const unsigned suit { static_cast<unsigned>(hand >> (__builtin_ctzll(flushLanes) & ~15)) & 0x1FFF };
+            if (straights[suit])
+                return score(straightFlush, straights[suit]);
+            return score(flush, topRanks[suit]);
+        }
+        return rankTable.find(rankKeys[hand & 0x1FFF] + rankKeys[(hand >> 16) & 0x1FFF] + rankKeys[(hand >> 32) & 0x1FFF]
+                              + rankKeys[hand >> 48]);
+    }
+}
+
+#endif
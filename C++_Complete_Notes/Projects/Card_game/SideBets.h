@@ -0,0 +1,113 @@
+#ifndef SIDE_BETS_H
+#define SIDE_BETS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "Card.h"
+
+// Black-Jack side bets, settled from the first three cards of a round:
+//   21+3:          the player's two cards plus the dealer's upcard, read as a three-card poker hand.
+//   Perfect Pairs: the player's two cards, paid when they are a pair.
+// Both are settled with one lookup in a small table built at compile time, straight from Card::index() values,
+// so settling a side bet costs the game loop next to nothing.
+namespace SideBets
+{
+    enum TwentyOneThree : std::uint8_t
+    {
+        noTwentyOneThree,
+        threeCardFlush,
+        threeCardStraight,
+        threeOfAKind,
+        straightFlush,
+        suitedTrips,
+
+        maxTwentyOneThree
+    };
+    constexpr std::array<std::string_view,maxTwentyOneThree> twentyOneThreeName {
+        "nothing", "flush", "straight", "three of a kind", "straight flush", "suited trips"
+    };
+    constexpr std::array<int,maxTwentyOneThree> twentyOneThreePays {0, 5, 10, 30, 40, 100}; // to one
+
+    enum PerfectPairs : std::uint8_t
+    {
+        noPair,
+        mixedPair,    // different colours
+        colouredPair, // same colour, different suits
+        perfectPair,  // same suit (only possible with more than one deck)
+
+        maxPerfectPairs
+    };
+    constexpr std::array<std::string_view,maxPerfectPairs> perfectPairsName {
+        "nothing", "mixed pair", "coloured pair", "perfect pair"
+    };
+    constexpr std::array<int,maxPerfectPairs> perfectPairsPays {0, 6, 12, 25}; // to one
+
+    constexpr int cards {52};
+
+    constexpr bool red(Card::Suits suit) { return suit == Card::suits_diamonds || suit == Card::suits_hearts; }
+
+    constexpr TwentyOneThree classify(Card a, Card b, Card c)
+    {
+        const bool suited { a.suitCard == b.suitCard && b.suitCard == c.suitCard };
+        if (a.rankCard == b.rankCard && b.rankCard == c.rankCard)
+            return suited ? suitedTrips : threeOfAKind;
+
+        // Three different ranks in a row, with the ace either below the deuce or above the king:
+        const int mask { (1 << a.rankCard) | (1 << b.rankCard) | (1 << c.rankCard) };
+        const int lowest { mask & -mask };
+        const bool straight { mask == lowest * 7
+                              || mask == ((1 << Card::rank_queen) | (1 << Card::rank_king) | (1 << Card::rank_ace)) };
+
+        if (straight)
+            return suited ? straightFlush : threeCardStraight;
+        return suited ? threeCardFlush : noTwentyOneThree;
+    }
+    constexpr PerfectPairs classify(Card a, Card b)
+    {
+        if (a.rankCard != b.rankCard)
+            return noPair;
+        if (a.suitCard == b.suitCard)
+            return perfectPair;
+        return red(a.suitCard) == red(b.suitCard) ? colouredPair : mixedPair;
+    }
+
+    // 21+3 only depends on the three ranks and whether all three cards share a suit, so its table is indexed by
+    // the ranks and a suited bit: (((a * 13 + b) * 13 + c) * 2 + suited). Perfect Pairs is indexed by a * 52 + b
+    // with a, b the cards' Card::index().
+    constexpr int ranks {Card::maxRank};
+    constexpr std::array<TwentyOneThree,ranks * ranks * ranks * 2> makeTwentyOneThreeTable()
+    {
+        std::array<TwentyOneThree,ranks * ranks * ranks * 2> table {};
+        for (int a {0}; a < ranks; ++a)
+            for (int b {0}; b < ranks; ++b)
+                for (int c {0}; c < ranks; ++c)
+                {
+                    const Card first { Card::allRank[a], Card::suits_clubs };
+                    const Card second { Card::allRank[b], Card::suits_clubs };
+                    table[((a * ranks + b) * ranks + c) * 2] = classify(first, second, Card{ Card::allRank[c], Card::suits_hearts });
+                    table[((a * ranks + b) * ranks + c) * 2 + 1] = classify(first, second, Card{ Card::allRank[c], Card::suits_clubs });
+                }
+        return table;
+    }
+    constexpr std::array<PerfectPairs,cards * cards> makePerfectPairsTable()
+    {
+        std::array<PerfectPairs,cards * cards> table {};
+        for (int a {0}; a < cards; ++a)
+            for (int b {0}; b < cards; ++b)
+                table[a * cards + b] = classify(Card::fromIndex(a), Card::fromIndex(b));
+        return table;
+    }
+    inline constexpr std::array<TwentyOneThree,ranks * ranks * ranks * 2> twentyOneThreeTable { makeTwentyOneThreeTable() };
+    inline constexpr std::array<PerfectPairs,cards * cards> perfectPairsTable { makePerfectPairsTable() };
+
+    // Takes Card::index() values, as stored in Table::cards:
+    inline TwentyOneThree twentyOneThree(int first, int second, int upcard)
+    {
+        const int suited { first / ranks == second / ranks && second / ranks == upcard / ranks };
+        return twentyOneThreeTable[(((first % ranks) * ranks + second % ranks) * ranks + upcard % ranks) * 2 + suited];
+    }
+    inline PerfectPairs perfectPairs(int first, int second) { return perfectPairsTable[first * cards + second]; }
+}
+
+#endif
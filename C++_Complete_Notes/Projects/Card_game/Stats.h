@@ -0,0 +1,100 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// Live simulation statistics.
+// Every worker thread counts into its own slot with plain (non-atomic) adds, and every so often publishes a copy
+// of its counts under a sequence lock. A monitoring thread can then take a consistent snapshot of all workers
+// at any time without ever making a worker wait. Slots are cache-line aligned, so workers never share a line.
+namespace Stats
+{
+    enum Counter
+    {
+        hands,
+        wins,
+        ties,
+        losses,
+        busts,          // seat hands that went over the bust limit
+        aceSoftenings,  // aces dropped from 11 to 1, dealer included
+        reshuffles,
+
+        maxCounter
+    };
+    constexpr std::array<std::string_view,maxCounter> counterName {
+        "hands", "wins", "ties", "losses", "busts", "ace softenings", "reshuffles"
+    };
+
+    using Counts = std::array<std::uint64_t,maxCounter>;
+
+    class Board
+    {
+    private:
+        struct alignas(64) Slot
+        {
+            Counts running {};                     // owned by the worker, no synchronisation
+            std::atomic<std::uint32_t> sequence {0}; // odd while the worker is publishing
+            std::array<std::atomic<std::uint64_t>,maxCounter> published {};
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        int m_workers {};
+
+    public:
+        explicit Board(int workers)
+            : m_slots { std::make_unique<Slot[]>(static_cast<std::size_t>(workers)) }
+            , m_workers { workers }
+        {
+        }
+
+        // Worker side: count into the worker's own slot.
+        void add(int worker, Counter counter, std::uint64_t amount = 1) { m_slots[worker].running[counter] += amount; }
+
+        // Worker side: the worker's own counts so far, for working out what one piece of work added.
+        const Counts& running(int worker) const { return m_slots[worker].running; }
+
+        // Worker side: makes the worker's counts visible to snapshot(). Cheap enough to call every few thousand hands.
+        void publish(int worker)
+        {
+            Slot& slot { m_slots[worker] };
+            const std::uint32_t sequence { slot.sequence.load(std::memory_order_relaxed) };
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int counter {0}; counter < maxCounter; ++counter)
+                slot.published[counter].store(slot.running[counter], std::memory_order_relaxed);
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Monitor side: the sum over all workers of what they last published. Each worker's counts are read
+        // as one consistent set; a read that overlapped a publish is simply retried.
+        Counts snapshot() const
+        {
+            Counts total {};
+            for (int worker {0}; worker < m_workers; ++worker)
+            {
+                const Slot& slot { m_slots[worker] };
+                Counts counts {};
+                std::uint32_t before {};
+                std::uint32_t after {};
+                do
+                {
+                    before = slot.sequence.load(std::memory_order_acquire);
+                    for (int counter {0}; counter < maxCounter; ++counter)
+                        counts[counter] = slot.published[counter].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    after = slot.sequence.load(std::memory_order_relaxed);
+                } while ((before & 1) || before != after);
+
+                for (int counter {0}; counter < maxCounter; ++counter)
+                    total[counter] += counts[counter];
+            }
+            return total;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, write
+
+// Hit/stand strategy for Black-Jack, solved for an infinite shoe, with the EV of every decision.
+// Solved tables are saved as a raw binary image ("strategy-b<bust>-d<dealer>.bin"). Later runs mmap that file
+// read-only and use it in place, so there is nothing to parse, and every process on the host shares the same pages.
+// If the file is missing, stale or for other rules, the tables are solved again and the file is rewritten.
+namespace Strategy
+{
+    constexpr std::uint32_t version {1};
+    constexpr int maxTotal {32};  // hand totals 0-31, so the bust limit can be at most 31
+    constexpr int upcards {10};   // dealer upcard values 2-11, stored at [value - 2]
+    constexpr int maxAces {3};    // soft aces the solver tracks (more than one only matters for bust limits above 21)
+
+    // The file layout: plain data only, so a mapped file can be used directly as a Tables.
+    struct Tables
+    {
+        std::array<char,8> magic {'B','J','S','T','R','A','T','\0'};
+        std::uint32_t version {Strategy::version};
+        std::int32_t bustLimit {};
+        std::int32_t dealerLimit {};
+        std::uint32_t size { sizeof(Tables) };
+        // Indexed by [soft][total][upcard - 2]:
+        double standEv[2][maxTotal][upcards] {};
+        double hitEv[2][maxTotal][upcards] {};
+        std::uint8_t hit[2][maxTotal][upcards] {};
+
+        bool wantHit(int total, bool soft, int upcard) const { return hit[soft][total][upcard - 2]; }
+    };
+    static_assert(std::is_trivially_copyable_v<Tables>);
+
+    inline bool matches(const Tables& tables, int bustLimit, int dealerLimit)
+    {
+        return tables.magic == Tables{}.magic && tables.version == version && tables.size == sizeof(Tables)
+            && tables.bustLimit == bustLimit && tables.dealerLimit == dealerLimit;
+    }
+
+    // Infinite shoe: ace through nine are 1/13 each, ten-value cards are 4/13. Aces are drawn as 11.
+    constexpr std::array<int,10> cardValue {2,3,4,5,6,7,8,9,10,11};
+    constexpr std::array<double,10> cardChance {1/13.0, 1/13.0, 1/13.0, 1/13.0, 1/13.0, 1/13.0, 1/13.0, 1/13.0, 4/13.0, 1/13.0};
+
+    struct Hand
+    {
+        int total {};
+        int aces {}; // aces still counted as 11
+    };
+    inline Hand draw(Hand hand, int value, int bustLimit)
+    {
+        hand.total += value;
+        if (value == 11)
+            ++hand.aces;
+        while (hand.total > bustLimit && hand.aces > 0)
+        {
+            hand.total -= 10;
+            --hand.aces;
+        }
+        hand.aces = std::min(hand.aces, maxAces);
+        return hand;
+    }
+
+    // Solves both tables with dynamic programming over (total, soft aces).
+    // Dealer totals above the hand total scale are folded into "bust" at index maxTotal.
+    inline void solve(Tables& tables, int bustLimit, int dealerLimit)
+    {
+        using Outcome = std::array<double, maxTotal + 1>;
+        tables.bustLimit = bustLimit;
+        tables.dealerLimit = dealerLimit;
+
+        // Chance of the dealer ending on each total, starting from every hand state:
+        std::array<std::array<Outcome, maxAces + 1>, maxTotal> dealer {};
+        std::array<std::array<bool, maxAces + 1>, maxTotal> dealerDone {};
+        auto dealerFrom { [&](auto& self, Hand hand) -> const Outcome& {
+            Outcome& out { dealer[hand.total][hand.aces] };
+            if (dealerDone[hand.total][hand.aces])
+                return out;
+            dealerDone[hand.total][hand.aces] = true;
+            if (hand.total >= dealerLimit)
+            {
+                out[hand.total] = 1.0;
+                return out;
+            }
+            for (std::size_t card {0}; card < cardValue.size(); ++card)
+            {
+                const Hand next { draw(hand, cardValue[card], bustLimit) };
+                if (next.total > bustLimit)
+                {
+                    out[maxTotal] += cardChance[card];
+                    continue;
+                }
+                const Outcome& after { self(self, next) };
+                for (int total {0}; total <= maxTotal; ++total)
+                    out[total] += cardChance[card] * after[total];
+            }
+            return out;
+        } };
+
+        for (int up {0}; up < upcards; ++up)
+        {
+            const Outcome& dealerEnds { dealerFrom(dealerFrom, draw(Hand{}, cardValue[up], bustLimit)) };
+
+            // Standing on `total` wins when the dealer busts or ends lower:
+            std::array<double, maxTotal> stand {};
+            for (int total {0}; total <= bustLimit; ++total)
+            {
+                double ev { dealerEnds[maxTotal] };
+                for (int dealerTotal {0}; dealerTotal <= bustLimit; ++dealerTotal)
+                {
+                    if (dealerTotal < total)
+                        ev += dealerEnds[dealerTotal];
+                    else if (dealerTotal > total)
+                        ev -= dealerEnds[dealerTotal];
+                }
+                stand[total] = ev;
+            }
+
+            // A soft hand can drop to a lower hard total, but every draw raises the total counted with all aces as 1,
+            // so the recursion always ends:
+            std::array<std::array<double, maxAces + 1>, maxTotal> best {};
+            std::array<std::array<double, maxAces + 1>, maxTotal> hitEv {};
+            std::array<std::array<bool, maxAces + 1>, maxTotal> solved {};
+            auto bestFrom { [&](auto& self, Hand hand) -> double {
+                if (!solved[hand.total][hand.aces])
+                {
+                    solved[hand.total][hand.aces] = true;
+                    double ev {0.0};
+                    for (std::size_t card {0}; card < cardValue.size(); ++card)
+                    {
+                        const Hand next { draw(hand, cardValue[card], bustLimit) };
+                        ev += cardChance[card] * (next.total > bustLimit ? -1.0 : self(self, next));
+                    }
+                    hitEv[hand.total][hand.aces] = ev;
+                    best[hand.total][hand.aces] = std::max(stand[hand.total], ev);
+                }
+                return best[hand.total][hand.aces];
+            } };
+            for (int total { bustLimit }; total >= 0; --total)
+            {
+                for (int soft {0}; soft < 2; ++soft)
+                    bestFrom(bestFrom, Hand{ total, soft });
+                for (int soft {0}; soft < 2; ++soft)
+                {
+                    tables.standEv[soft][total][up] = stand[total];
+                    tables.hitEv[soft][total][up] = hitEv[total][soft];
+                    tables.hit[soft][total][up] = hitEv[total][soft] > stand[total];
+                }
+            }
+        }
+    }
+
+    inline std::string fileName(int bustLimit, int dealerLimit)
+    {
+        return "strategy-b" + std::to_string(bustLimit) + "-d" + std::to_string(dealerLimit) + ".bin";
+    }
+
+    // Writes the tables to a temporary file and renames it into place, so a reader never maps a half-written file.
+    inline bool save(const Tables& tables, const std::string& path)
+    {
+        const std::string temp { path + ".tmp" + std::to_string(::getpid()) };
+        const int fd { ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) };
+        if (fd < 0)
+            return false;
+        const bool written { ::write(fd, &tables, sizeof(Tables)) == static_cast<ssize_t>(sizeof(Tables)) };
+        ::close(fd);
+        if (!written || std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Strategy tables for one pair of rules, either mapped from disk or solved in memory.
+    class Handle
+    {
+    private:
+        const Tables* m_tables {nullptr};
+        void* m_mapping {nullptr};
+        std::unique_ptr<Tables> m_solved {};
+    public:
+        Handle(int bustLimit, int dealerLimit)
+        {
+            const std::string path { fileName(bustLimit, dealerLimit) };
+            const int fd { ::open(path.c_str(), O_RDONLY) };
+            if (fd >= 0)
+            {
+                struct stat info {};
+                if (::fstat(fd, &info) == 0 && info.st_size == static_cast<off_t>(sizeof(Tables)))
+                {
+                    void* mapping { ::mmap(nullptr, sizeof(Tables), PROT_READ, MAP_SHARED, fd, 0) };
+                    if (mapping != MAP_FAILED)
+                    {
+                        if (matches(*static_cast<const Tables*>(mapping), bustLimit, dealerLimit))
+                        {
+                            m_mapping = mapping;
+                            m_tables = static_cast<const Tables*>(mapping);
+                        }
+                        else
+                        {
+                            ::munmap(mapping, sizeof(Tables));
+                        }
+                    }
+                }
+                ::close(fd); // the mapping stays valid after the descriptor is closed
+            }
+            if (!m_tables)
+            {
+                m_solved = std::make_unique<Tables>();
+                solve(*m_solved, bustLimit, dealerLimit);
+                save(*m_solved, path); // best effort: without a writable directory we just solve again next time
+                m_tables = m_solved.get();
+            }
+        }
+        ~Handle()
+        {
+            if (m_mapping)
+                ::munmap(m_mapping, sizeof(Tables));
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        const Tables& tables() const { return *m_tables; }
+        bool mapped() const { return m_mapping != nullptr; }
+    };
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small work-stealing pool for running a fixed list of independent tasks across cores.
+// Each worker owns a deque of task indices: it pops its own work from the back and,
+// once that runs dry, steals from the front of another worker's deque.
+// Tasks are plain indices, so callers keep their inputs and outputs in arrays indexed by task.
+class TaskPool
+{
+private:
+    struct alignas(64) Worker // one cache line per worker, so neighbouring locks don't false-share
+    {
+        std::mutex lock {};
+        std::deque<std::size_t> tasks {};
+    };
+
+    std::vector<Worker> m_workers;
+
+    bool popOwn(int worker, std::size_t& task)
+    {
+        std::lock_guard guard { m_workers[worker].lock };
+        if (m_workers[worker].tasks.empty())
+            return false;
+        task = m_workers[worker].tasks.back();
+        m_workers[worker].tasks.pop_back();
+        return true;
+    }
+    bool steal(int thief, std::size_t& task)
+    {
+        const int count { static_cast<int>(m_workers.size()) };
+        for (int offset {1}; offset < count; ++offset)
+        {
+            Worker& victim { m_workers[(thief + offset) % count] };
+            std::lock_guard guard { victim.lock };
+            if (!victim.tasks.empty())
+            {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit TaskPool(int threads)
+        : m_workers(static_cast<std::size_t>(std::max(threads, 1)))
+    {
+    }
+
+    int threads() const { return static_cast<int>(m_workers.size()); }
+
+    // Runs run(task, worker) for every task in [0, taskCount) and returns once all of them are done.
+    // Tasks start out dealt to the workers in contiguous blocks, so neighbouring tasks tend to share a worker.
+    void run(std::size_t taskCount, const std::function<void(std::size_t task, int worker)>& run)
+    {
+        const std::size_t count { m_workers.size() };
+        for (std::size_t worker {0}; worker < count; ++worker)
+        {
+            const std::size_t first { taskCount * worker / count };
+            const std::size_t last { taskCount * (worker + 1) / count };
+            // Pushed in reverse so the owner pops its block front to back:
+            for (std::size_t task { last }; task > first; --task)
+                m_workers[worker].tasks.push_back(task - 1);
+        }
+
+        auto work { [&](int worker) {
+            std::size_t task {};
+            while (popOwn(worker, task) || steal(worker, task))
+                run(task, worker);
+        } };
+
+        std::vector<std::thread> threads {};
+        for (int worker {1}; worker < static_cast<int>(count); ++worker)
+            threads.emplace_back(work, worker);
+        work(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef TRANSCRIPT_H
+#define TRANSCRIPT_H
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include "Card.h"
+
+#include <unistd.h> // write
+
+// The running commentary of the interactive game ("The Dealer Flips a 7H. ...").
+// Text is formatted into a fixed buffer, cards are copied from a table of pre-rendered two-character glyphs,
+// and the buffer goes out in one write() per hand (or before waiting for the player at the keyboard),
+// instead of a chain of small std::cout insertions per card. When the transcript goes to a file or a pipe rather
+// than a terminal, nobody is watching hand by hand, so endHand() leaves whole hands in the buffer until it fills.
+// Building with -DTRANSCRIPT_DISABLED compiles the commentary out entirely, leaving the game silent.
+// Two-character glyphs for every card, jokers included, indexed by Card::index():
+constexpr int cardGlyphCount { Card::maxSuits * (Card::maxRank + 1) };
+constexpr std::array<std::array<char,2>,cardGlyphCount> makeCardGlyphs()
+{
+    constexpr std::string_view ranks {"A23456789TJQK*"};
+    constexpr std::string_view suits {"CDHS"};
+    std::array<std::array<char,2>,cardGlyphCount> glyphs {};
+    for (int index {0}; index < cardGlyphCount; ++index)
+    {
+        const Card card { Card::fromIndex(index) };
+        glyphs[static_cast<std::size_t>(card.index())] = { ranks[card.rankCard], suits[card.suitCard] };
+    }
+    return glyphs;
+}
+inline constexpr std::array<std::array<char,2>,cardGlyphCount> cardGlyphs { makeCardGlyphs() };
+
+class Transcript
+{
+private:
+    static constexpr std::size_t capacity {8192};
+    std::array<char,capacity> m_text {};
+    std::size_t m_used {0};
+    int m_fd {STDOUT_FILENO};
+    bool m_terminal { ::isatty(STDOUT_FILENO) == 1 };
+
+    void reserve(std::size_t size)
+    {
+        if (m_used + size > capacity)
+            flush();
+    }
+
+public:
+#ifndef TRANSCRIPT_DISABLED
+    Transcript& operator<<(std::string_view text)
+    {
+        while (text.size() > capacity - m_used)
+        {
+            const std::size_t part { capacity - m_used };
+            text.copy(m_text.data() + m_used, part);
+            m_used += part;
+            text.remove_prefix(part);
+            flush();
+        }
+        m_used += text.copy(m_text.data() + m_used, text.size());
+        return *this;
+    }
+    Transcript& operator<<(char c)
+    {
+        reserve(1);
+        m_text[m_used++] = c;
+        return *this;
+    }
+    Transcript& operator<<(int value)
+    {
+        reserve(11);
+        m_used = static_cast<std::size_t>(std::to_chars(m_text.data() + m_used, m_text.data() + capacity, value).ptr - m_text.data());
+        return *this;
+    }
+    Transcript& operator<<(Card card)
+    {
+        reserve(2);
+        const auto& glyph { cardGlyphs[static_cast<std::size_t>(card.index())] };
+        m_text[m_used] = glyph[0];
+        m_text[m_used + 1] = glyph[1];
+        m_used += 2;
+        return *this;
+    }
+    // Writes out everything so far:
+    void flush()
+    {
+        std::size_t done {0};
+        while (done < m_used)
+        {
+            const ssize_t wrote { ::write(m_fd, m_text.data() + done, m_used - done) };
+            if (wrote <= 0)
+                break; // nowhere to write to; the commentary is lost, not the game
+            done += static_cast<std::size_t>(wrote);
+        }
+        m_used = 0;
+    }
+    // Marks the end of a hand: written straight away on a terminal, otherwise once the buffer is nearly full.
+    void endHand()
+    {
+        if (m_terminal || m_used > capacity / 2)
+            flush();
+    }
+#else
+    Transcript& operator<<(std::string_view) { return *this; }
+    Transcript& operator<<(char) { return *this; }
+    Transcript& operator<<(int) { return *this; }
+    Transcript& operator<<(Card) { return *this; }
+    void flush() {}
+    void endHand() {}
+#endif
+};
+
+// One transcript for the whole program, like std::cout:
+inline Transcript transcript {};
+
+#endif
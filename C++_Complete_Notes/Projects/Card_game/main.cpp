@@ -1,119 +1,146 @@
 #include <string>
 #include <string_view>
 #include <array>
+#include <vector>
 #include <utility> // Required for std::pair
 #include <cassert>
-#include <algorithm> // for std::shuffle
-#include "Random.h"  // for Random::mt
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm> // for std::shuffle (the shoe stream)
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <stdexcept>
+#include <csignal>
+#include <sys/mman.h>     // mmap
+#include <sys/resource.h> // setrlimit
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // fork
+#include <fcntl.h>        // open
+#include "Random.h"  // for Random::mt, Random::shuffle
+#include "Card.h"
+#include "Deck.h"
+#include "TaskPool.h"
+#include "Strategy.h"
+#include "HandHistory.h"
+#include "Stats.h"
+#include "AllocCount.h"
+#include "SideBets.h"
+#include "DecisionReader.h"
+#include "Transcript.h"
+#include <map>
+#include <memory>
 #include <iostream>
+#include <iomanip>
 
 using namespace std;
 
-struct Card
-{
-        
-    enum Rank
-    {
-        rank_ace,
-        rank_2,
-        rank_3,
-        rank_4,
-        rank_5,
-        rank_6,
-        rank_7,
-        rank_8,
-        rank_9,
-        rank_10,
-        rank_jack,
-        rank_queen,
-        rank_king,
-
-        maxRank
-    };
-    enum Suits
-    {
-        suits_clubs,
-        suits_diamonds,
-        suits_hearts,
-        suits_spades,
-
-        maxSuits
-    };
-
-    constexpr static std::array<Rank,maxRank> allRank { 
-        rank_ace,
-        rank_2,
-        rank_3,
-        rank_4,
-        rank_5,
-        rank_6,
-        rank_7,
-        rank_8,
-        rank_9,
-        rank_10,
-        rank_jack,
-        rank_queen,
-        rank_king
-    };
-    constexpr static std::array<Suits,maxSuits> allSuits {
-        suits_clubs,
-        suits_diamonds,
-        suits_hearts,
-        suits_spades
-    };
-
-    Rank rankCard {};
-    Suits suitCard {};
-
-    friend std::ostream& operator<<(std::ostream& out, const Card &card)
-    {
-        static std::array<char,maxRank> rank { 'A','2','3','4','5','6','7','8','9','T','J','Q','K' };
-        static std::array<char,maxSuits> suit {'C','D','H','S'};
-
-        out << rank[card.rankCard] << suit[card.suitCard];
-        return out;
-    }
-    int val() const
-    {
-        static constexpr std::array<int,maxRank> rankVal {11,2,3,4,5,6,7,8,9,10,10,10,10};
-        return rankVal[rankCard];
-    }
+// Implementing Black-Jack:
+namespace Settings
+{
+    const int bustLimit {21};
+    const int dealerLimit {17};
+    // Multi-seat tables:
+    const int maxSeats {7};
+    const int numDecks {6};
+    const double penetration {0.75}; // Fraction of the shoe dealt before the cut card comes out
+    const int wager {1};
+    const double winPayout {1.0};
+    const double blackjackPayout {1.5};
+    // Winnings are counted in whole thousandths of a wager, so totals add up exactly in any order:
+    const long long unitsPerWager {1000};
+    const int sideBetWager {1}; // on each of 21+3 and Perfect Pairs, when side bets are played
+}
+// One set of table rules. The defaults come from Settings; the rule sweep builds one Rules per configuration.
+struct Rules
+{
+    int bustLimit {Settings::bustLimit};
+    int dealerLimit {Settings::dealerLimit};
+    int numDecks {Settings::numDecks};
+    double penetration {Settings::penetration};
+    double winPayout {Settings::winPayout};
+    double blackjackPayout {Settings::blackjackPayout};
 };
-class Deck
+// A shoe is several decks shuffled together, shared by every seat at a table:
+class Shoe
 {
 private:
-    std::array<Card,52> m_cards {};
-     std::size_t m_nextCardIndex {0};
+    std::vector<Card> m_cards {};
+    std::size_t m_nextCardIndex {0};
+    std::size_t m_roundStart {0}; // the cards from here to m_nextCardIndex are on the table
+    std::size_t m_cutCard {0};
+    bool m_exhausted {false};
+    int m_reshuffles {0};
+
+    // The shoe ran out in the middle of a round. The cards on the table stay where they are, and only the
+    // discards of the earlier rounds are shuffled and dealt; the shoe then counts as finished.
+    // (One round can't use up a whole deck: a hand stops by its bust limit plus ten, so with limits up to 31
+    // eight hands hold at most 8 * 41 points, while a deck has 340.)
+    void reshuffleDiscards()
+    {
+        assert(m_roundStart > 0 && "A round has used up the whole shoe!");
+        const auto roundStart { m_cards.begin() + static_cast<std::ptrdiff_t>(m_roundStart) };
+        std::rotate(m_cards.begin(), roundStart, m_cards.end()); // the round's cards first, then the discards
+        m_nextCardIndex = m_cards.size() - m_roundStart;
+        m_roundStart = {0};
+        // The generator is seeded from the discards themselves, so the same shoe always reshuffles the same way:
+        std::uint32_t seed { 2166136261u };
+        for (std::size_t i { m_nextCardIndex }; i < m_cards.size(); ++i)
+            seed = (seed ^ static_cast<std::uint32_t>(m_cards[i].index())) * 16777619u;
+        std::mt19937 mt { seed };
+        std::shuffle(m_cards.begin() + static_cast<std::ptrdiff_t>(m_nextCardIndex), m_cards.end(), mt);
+        m_exhausted = true;
+    }
 public:
-    Deck()
+    explicit Shoe(const Rules& rules = {})
     {
-        std::size_t count {0};
-        for(auto suit : Card::allSuits)
+        assert(rules.numDecks > 0 && rules.penetration > 0.0 && rules.penetration <= 1.0);
+        m_cards.reserve(static_cast<std::size_t>(rules.numDecks) * 52);
+        for (int deck {0}; deck < rules.numDecks; ++deck)
         {
-            for(auto rank : Card::allRank)
-            {
-                m_cards[count++] = Card{rank,suit} ;
-            }
+            const auto& image { canonicalDeck<Card,52> };
+            m_cards.insert(m_cards.end(), image.begin(), image.end());
         }
+        m_cutCard = static_cast<std::size_t>(rules.penetration * static_cast<double>(m_cards.size()));
     }
     Card dealCard()
     {
-        assert( m_nextCardIndex != 52 && "Deck Has Gone Through All Cards!" );
+        if (m_nextCardIndex == m_cards.size())
+        {
+            reshuffleDiscards();
+        }
         return m_cards[m_nextCardIndex++];
     }
+    // Every card dealt from here on is on the table until the next round starts:
+    void startRound() { m_roundStart = m_nextCardIndex; }
+    // Replaces the shoe with an already shuffled order of card indices (one per card in the shoe):
+    void load(const std::uint8_t* order)
+    {
+        for (auto& card : m_cards)
+            card = Card::fromIndex(*order++);
+        m_nextCardIndex = {0};
+        m_roundStart = {0};
+        m_exhausted = false;
+    }
     void shuffle()
     {
-        std::shuffle(m_cards.begin(), m_cards.end(), Random::mt);
+        Random::shuffle(m_cards.begin(), m_cards.end());
         m_nextCardIndex = {0};
+        m_roundStart = {0};
+        m_exhausted = false;
+        ++m_reshuffles;
     }
-
+    bool cutCardReached() const { return m_nextCardIndex >= m_cutCard || m_exhausted; }
+    int reshuffles() const { return m_reshuffles; }
 };
-// Implementing Black-Jack:
-namespace Settings
-{
-    const int bustLimit {21};
-    const int dealerLimit {17};
-}
 struct Player
 {
     int score {0};
@@ -121,7 +148,7 @@ struct Player
     int aceCount {0};
 
 };
-bool dealerTurn(Deck& deck, Player& dealer)
+bool dealerTurn(StandardDeck& deck, Player& dealer)
 {
     while (dealer.score < Settings::dealerLimit)
     {
@@ -138,21 +165,32 @@ bool dealerTurn(Deck& deck, Player& dealer)
             dealer.aceCount--;
         }
         //
-        std::cout << "The Dealer Flips a " << card << ".\t" << "They now have: " << dealer.score << '\n';  
+        transcript << "The Dealer Flips a " << card << ".\t" << "They now have: " << dealer.score << '\n';
     }
     if (dealer.score > Settings::dealerLimit)
     {
-        std::cout << "The dealer went bust!\n";
+        transcript << "The dealer went bust!\n";
         return true;
     }
     return false;
 }
-bool playerWantHit()
+// Asks for a decision, from the keyboard or from a decision script:
+bool playerWantHit(DecisionReader* script)
 {
     while (true)
     {
-        std::cout << "(h) to hit, or (s) to stand: ";
-        char choice {}; std::cin >> choice;
+        transcript << "(h) to hit, or (s) to stand: ";
+        char choice {};
+        if (script)
+        {
+            choice = script->next();
+            transcript << choice << '\n';
+        }
+        else
+        {
+            transcript.flush(); // the player has to see the table before deciding
+            std::cin >> choice;
+        }
 
         switch (choice)
         {
@@ -164,10 +202,10 @@ bool playerWantHit()
     }
     
 }
-bool playerturn(Deck& deck, Player& player)
+bool playerturn(StandardDeck& deck, Player& player, DecisionReader* script)
 {
 
-    while ( player.score < Settings::bustLimit && playerWantHit() )
+    while ( player.score < Settings::bustLimit && playerWantHit(script) )
     {
         Card card { deck.dealCard() };
         player.score += card.val();
@@ -182,11 +220,11 @@ bool playerturn(Deck& deck, Player& player)
             player.aceCount--;
         }
         //
-        std::cout << "You were dealt " << card << ".\t" << "You now have: " << player.score << '\n';
+        transcript << "You were dealt " << card << ".\t" << "You now have: " << player.score << '\n';
     }
     if (player.score > Settings::bustLimit)
     {
-        std::cout  << "Player Went Bust.\n";
+        transcript << "Player Went Bust.\n";
         return true;
     }
     return false;
@@ -199,16 +237,18 @@ enum Result
     Win, // Player Won
     Lose, // Dealer Won
 };
-Result playBlackJack()
+static_assert(static_cast<int>(Result::Tie) == History::recordTie && static_cast<int>(Result::Win) == History::recordWin
+              && static_cast<int>(Result::Lose) == History::recordLose);
+Result playBlackJack(DecisionReader* script = nullptr)
 {
-    Deck deck{};
+    StandardDeck deck{};
     deck.shuffle();
     // Dealer Turns:
     Player dealer {};
     // you will need to show the dealer’s initial card
     Card initialCard_Dealer { deck.dealCard() };
     dealer.score = { initialCard_Dealer.val() };
-    std::cout << "The Dealer is showing " << initialCard_Dealer << " (" << dealer.score << ")" <<"\n"; 
+    transcript << "The Dealer is showing " << initialCard_Dealer << " (" << dealer.score << ")" << "\n";
     //
     // Player Turns:
     Player player {};
@@ -216,11 +256,11 @@ Result playBlackJack()
 
     std::pair<Card,Card> initialCard_Player {deck.dealCard(),deck.dealCard()};
     player.score = { initialCard_Player.first.val() + initialCard_Player.second.val() };
-    std::cout << "You are showing : " << initialCard_Player.first << " " << initialCard_Player.second << " (" << player.score << ")" << "\n"; 
+    transcript << "You are showing : " << initialCard_Player.first << " " << initialCard_Player.second << " (" << player.score << ")" << "\n";
 
     //
     // Player Logic here:
-    if (playerturn(deck,player))
+    if (playerturn(deck,player,script))
     {
         return Result::Lose; // If player went bust, then return false which will mean that player lost and dealer won!
     }
@@ -238,21 +278,1299 @@ Result playBlackJack()
 }
 
 
-int main() {
+// Multi-seat Black-Jack:
+// Seat state is stored as struct-of-arrays, so each step of a round walks one small array for every seat.
+struct Table
+{
+    int seatCount {1};
+    std::array<int,Settings::maxSeats> score {};
+    std::array<int,Settings::maxSeats> aceCount {};
+    std::array<int,Settings::maxSeats> wager {};
+    std::array<bool,Settings::maxSeats> natural {}; // dealt the bust limit in two cards
+    std::array<int,Settings::maxSeats> startScore {}; // after the first two cards
+    std::array<bool,Settings::maxSeats> startSoft {};
+    // The cards themselves, as Card::index() values, for hand histories:
+    std::array<int,Settings::maxSeats> cardCount {};
+    std::array<std::array<std::uint8_t,History::maxHandCards>,Settings::maxSeats> cards {};
+    Player dealer {};
+    int dealerCardCount {0};
+    std::array<std::uint8_t,History::maxHandCards> dealerCards {};
+    int softenings {0}; // aces dropped from 11 to 1 this round, for Stats
+};
+// Adds a card to a hand, counting an ace as 1 instead of 11 whenever the hand would go over the limit.
+// Returns how many aces that took:
+int addCard(int& score, int& aceCount, Card card, const Rules& rules)
+{
+    int softenings {0};
+    score += card.val();
+    if (card.val() == 11)
+    {
+        aceCount++;
+    }
+    while (score > rules.bustLimit && aceCount > 0)
+    {
+        score -= 10;
+        aceCount--;
+        ++softenings;
+    }
+    return softenings;
+}
+// Simulated seats play the solved hit/stand strategy for the dealer's upcard:
+bool seatWantHit(int score, int aceCount, int upcard, const Strategy::Tables& strategy)
+{
+    return strategy.wantHit(score, aceCount > 0, upcard);
+}
+// Plays one round for every seat at the table from the shared shoe, in casino dealing order:
+// one card to each seat, the dealer's upcard, then a second card to each seat.
+// The caller decides when the shoe gets reshuffled. Returns the number of cards the round used.
+int playRound(Table& table, Shoe& shoe, const Rules& rules, const Strategy::Tables& strategy,
+              std::array<Result,Settings::maxSeats>& results)
+{
+    shoe.startRound();
+    int cardsDealt {0};
+    auto dealSeat { [&](int seat) {
+        const Card card { shoe.dealCard() };
+        ++cardsDealt;
+        if (table.cardCount[seat] < History::maxHandCards)
+            table.cards[seat][table.cardCount[seat]] = static_cast<std::uint8_t>(card.index());
+        ++table.cardCount[seat];
+        table.softenings += addCard(table.score[seat], table.aceCount[seat], card, rules);
+    } };
+    auto dealDealer { [&]() {
+        const Card card { shoe.dealCard() };
+        ++cardsDealt;
+        if (table.dealerCardCount < History::maxHandCards)
+            table.dealerCards[table.dealerCardCount] = static_cast<std::uint8_t>(card.index());
+        ++table.dealerCardCount;
+        table.softenings += addCard(table.dealer.score, table.dealer.aceCount, card, rules);
+    } };
+
+    for (int seat {0}; seat < table.seatCount; ++seat)
+    {
+        table.score[seat] = 0;
+        table.aceCount[seat] = 0;
+        table.wager[seat] = Settings::wager;
+        table.cardCount[seat] = 0;
+    }
+    table.dealer = {};
+    table.dealerCardCount = 0;
+    table.softenings = 0;
+
+    for (int seat {0}; seat < table.seatCount; ++seat)
+        dealSeat(seat);
+    dealDealer();
+    const int upcard { table.dealer.score };
+    for (int seat {0}; seat < table.seatCount; ++seat)
+    {
+        dealSeat(seat);
+        table.natural[seat] = (table.score[seat] == rules.bustLimit);
+        table.startScore[seat] = table.score[seat];
+        table.startSoft[seat] = (table.aceCount[seat] > 0);
+    }
+
+    // Seats play left to right:
+    int seatsStanding {0};
+    for (int seat {0}; seat < table.seatCount; ++seat)
+    {
+        while (table.score[seat] < rules.bustLimit && seatWantHit(table.score[seat], table.aceCount[seat], upcard, strategy))
+        {
+            dealSeat(seat);
+        }
+        if (table.score[seat] <= rules.bustLimit)
+        {
+            ++seatsStanding;
+        }
+    }
+    // The dealer only draws if somebody is still in the round:
+    if (seatsStanding > 0)
+    {
+        while (table.dealer.score < rules.dealerLimit)
+        {
+            dealDealer();
+        }
+    }
+    const bool dealerBust { table.dealer.score > rules.bustLimit };
+
+    for (int seat {0}; seat < table.seatCount; ++seat)
+    {
+        const int score { table.score[seat] };
+        if (score > rules.bustLimit)
+            results[seat] = Result::Lose;
+        else if (dealerBust || score > table.dealer.score)
+            results[seat] = Result::Win;
+        else if (score == table.dealer.score)
+            results[seat] = Result::Tie;
+        else
+            results[seat] = Result::Lose;
+    }
+    return cardsDealt;
+}
+// What a seat won or lost on the round, in thousandths of a wager (Settings::unitsPerWager):
+long long seatNet(const Table& table, int seat, Result result, const Rules& rules)
+{
+    switch (result)
+    {
+    case Result::Win:
+        return table.wager[seat] * std::llround((table.natural[seat] ? rules.blackjackPayout : rules.winPayout) * Settings::unitsPerWager);
+    case Result::Lose:
+        return -table.wager[seat] * Settings::unitsPerWager;
+    default:
+        return 0;
+    }
+}
+// Builds the hand-history record for one seat after a round:
+History::HandRecord handRecord(const Table& table, int seat, Result result)
+{
+    History::HandRecord record {};
+    record.seat = static_cast<std::uint8_t>(seat);
+    record.result = static_cast<std::uint8_t>(result);
+    record.startTotal = static_cast<std::uint8_t>(table.startScore[seat]);
+    record.soft = table.startSoft[seat];
+    record.finalTotal = static_cast<std::uint8_t>(table.score[seat]);
+    record.dealerTotal = static_cast<std::uint8_t>(table.dealer.score);
+    record.playerCount = static_cast<std::uint8_t>(table.cardCount[seat]);
+    record.dealerCount = static_cast<std::uint8_t>(table.dealerCardCount);
+    record.playerCards = table.cards[seat];
+    record.dealerCards = table.dealerCards;
+    return record;
+}
+// Side bets a seat placed on the round, settled from its first two cards and the dealer's upcard, in units:
+long long sideBetNet(const Table& table, int seat)
+{
+    const int first { table.cards[seat][0] };
+    const int second { table.cards[seat][1] };
+    const int pays21Plus3 { SideBets::twentyOneThreePays[SideBets::twentyOneThree(first, second, table.dealerCards[0])] };
+    const int paysPairs { SideBets::perfectPairsPays[SideBets::perfectPairs(first, second)] };
+    // Each bet is either paid at its odds or lost:
+    return Settings::sideBetWager * Settings::unitsPerWager * ((pays21Plus3 ? pays21Plus3 : -1) + (paysPairs ? paysPairs : -1));
+}
+// Simulation Mode: plays `rounds` rounds at a table of `seats` seats and reports results per seat position.
+// With side bets on, every seat also plays 21+3 and Perfect Pairs each round.
+void simulateTable(int seats, long long rounds, bool sideBets)
+{
+    const Rules rules {};
+    const Strategy::Handle strategy { rules.bustLimit, rules.dealerLimit };
+    Table table {};
+    table.seatCount = seats;
+    Shoe shoe { rules };
+    shoe.shuffle();
+
+    std::array<Result,Settings::maxSeats> results {};
+    std::array<std::array<long long,3>,Settings::maxSeats> tally {}; // indexed by seat, then Result
+    std::array<long long,Settings::maxSeats> net {};
+    std::array<long long,Settings::maxSeats> sideNet {};
+    long long cardsDealt {0};
+
+    for (long long round {0}; round < rounds; ++round)
+    {
+        if (shoe.cutCardReached())
+        {
+            shoe.shuffle();
+        }
+        cardsDealt += playRound(table, shoe, rules, strategy.tables(), results);
+        for (int seat {0}; seat < seats; ++seat)
+        {
+            ++tally[seat][results[seat]];
+            net[seat] += seatNet(table, seat, results[seat], rules);
+        }
+        if (sideBets)
+        {
+            for (int seat {0}; seat < seats; ++seat)
+                sideNet[seat] += sideBetNet(table, seat);
+        }
+    }
+
+    std::cout << rounds << " rounds, " << seats << " seats, " << rules.numDecks << " decks ("
+              << shoe.reshuffles() << " shuffles), random seed " << Random::seedUsed() << '\n';
+    std::cout << "Cards per round: " << static_cast<double>(cardsDealt) / static_cast<double>(rounds) << '\n';
+    for (int seat {0}; seat < seats; ++seat)
+    {
+        std::cout << "Seat " << seat + 1 << ": " << tally[seat][Result::Win] << " wins, " << tally[seat][Result::Tie]
+                  << " ties, " << tally[seat][Result::Lose] << " losses, EV per hand "
+                  << static_cast<double>(net[seat]) / static_cast<double>(Settings::unitsPerWager * rounds);
+        if (sideBets)
+        {
+            std::cout << ", side bets EV per bet "
+                      << static_cast<double>(sideNet[seat]) / static_cast<double>(2 * Settings::sideBetWager * Settings::unitsPerWager * rounds);
+        }
+        std::cout << '\n';
+    }
+}
+// Side Bet Odds: the exact house edge of 21+3 and Perfect Pairs dealt from a full shoe of `decks` decks.
+// Every ordered deal of the first three cards is weighed by how many ways the shoe can produce it;
+// the first card splits the work across threads, and the per-card counts are added up in card order.
+int sideBetOdds(int decks)
+{
+    constexpr int cards {SideBets::cards};
+    std::vector<std::array<std::uint64_t,SideBets::maxTwentyOneThree>> twentyOneThree( cards );
+    std::vector<std::array<std::uint64_t,SideBets::maxPerfectPairs>> perfectPairs( cards );
+    const auto copies { static_cast<std::uint64_t>(decks) };
+
+    TaskPool pool { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    pool.run(cards, [&](std::size_t task, int) {
+        const int first { static_cast<int>(task) };
+        for (int second {0}; second < cards; ++second)
+        {
+            const std::uint64_t firstTwo { copies * (copies - (second == first)) };
+            perfectPairs[task][SideBets::perfectPairs(first, second)] += firstTwo;
+            for (int upcard {0}; upcard < cards; ++upcard)
+            {
+                const std::uint64_t ways { firstTwo * (copies - (upcard == first) - (upcard == second)) };
+                twentyOneThree[task][SideBets::twentyOneThree(first, second, upcard)] += ways;
+            }
+        }
+    });
+
+    auto report { [](std::string_view bet, const auto& names, const auto& pays, const auto& perCard) {
+        std::array<std::uint64_t,std::tuple_size_v<std::decay_t<decltype(pays)>>> ways {};
+        for (const auto& counts : perCard)
+            for (std::size_t outcome {0}; outcome < ways.size(); ++outcome)
+                ways[outcome] += counts[outcome];
+        std::uint64_t deals {0};
+        for (std::uint64_t count : ways)
+            deals += count;
+
+        std::cout << bet << '\n' << std::fixed;
+        long double ev {0.0L};
+        for (std::size_t outcome {0}; outcome < ways.size(); ++outcome)
+        {
+            const long double chance { static_cast<long double>(ways[outcome]) / static_cast<long double>(deals) };
+            ev += chance * (pays[outcome] ? pays[outcome] : -1);
+            std::cout << std::setw(18) << names[outcome] << std::setw(5) << pays[outcome] << ":1"
+                      << std::setw(14) << ways[outcome] << std::setw(12) << std::setprecision(6) << static_cast<double>(chance) << '\n';
+        }
+        std::cout << "  house edge " << std::setprecision(4) << static_cast<double>(-100.0L * ev) << "%\n" << std::defaultfloat;
+    } };
+    std::cout << "Side bets from a " << decks << " deck shoe:\n";
+    report("21+3", SideBets::twentyOneThreeName, SideBets::twentyOneThreePays, twentyOneThree);
+    report("Perfect Pairs", SideBets::perfectPairsName, SideBets::perfectPairsPays, perfectPairs);
+    return 0;
+}
+// Fixed-size output buffer for streaming cards without touching the heap; the caller empties it with clear():
+class FixedBuffer : public std::streambuf
+{
+private:
+    std::array<char,256> m_text {};
+public:
+    FixedBuffer() { clear(); }
+    void clear() { setp(m_text.data(), m_text.data() + m_text.size()); }
+    std::string_view view() const { return { pbase(), static_cast<std::size_t>(pptr() - pbase()) }; }
+};
+// Allocation Check: plays `rounds` rounds at a full table the way the simulations do, building a hand-history
+// record for every seat, passing it to a history writer and printing the cards into a fixed buffer, and counts
+// the heap allocations made on this thread. After a short warm-up the loop must make none.
+int allocCheck(long long rounds)
+{
+    const Rules rules {};
+    const Strategy::Handle strategy { rules.bustLimit, rules.dealerLimit };
+    Table table {};
+    table.seatCount = Settings::maxSeats;
+    Shoe shoe { rules };
+    shoe.shuffle();
+    std::array<Result,Settings::maxSeats> results {};
+    History::Writer history { "/dev/null", 1 << 12, true };
+    FixedBuffer buffer {};
+    std::ostream cardText { &buffer };
+    long long net {0};
+
+    auto play { [&](long long count) {
+        for (long long round {0}; round < count; ++round)
+        {
+            if (shoe.cutCardReached())
+                shoe.shuffle();
+            playRound(table, shoe, rules, strategy.tables(), results);
+            for (int seat {0}; seat < table.seatCount; ++seat)
+            {
+                net += seatNet(table, seat, results[seat], rules);
+                const History::HandRecord record { handRecord(table, seat, results[seat]) };
+                history.record(record);
+                buffer.clear();
+                for (int card {0}; card < std::min<int>(record.playerCount, History::maxHandCards); ++card)
+                    cardText << Card::fromIndex(record.playerCards[card]) << ' ';
+            }
+        }
+    } };
+
+    play(1000); // anything set up lazily on first use is paid for here
+    const std::uint64_t before { AllocCount::current() };
+    play(rounds);
+    const std::uint64_t allocations { AllocCount::current() - before };
+    history.stop();
+
+    const long long hands { rounds * table.seatCount };
+    std::cout << rounds << " rounds, " << hands << " hands: " << allocations << " heap allocations ("
+              << static_cast<double>(allocations) / static_cast<double>(hands) << " per hand), EV per hand "
+              << static_cast<double>(net) / static_cast<double>(Settings::unitsPerWager * hands) << '\n';
+    if (allocations != 0)
+    {
+        std::cerr << "The simulation loop allocated on the heap.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Rule-variant sweep:
+// Every configuration with the same deck count plays through the same stream of shuffled shoes, so the
+// differences between configurations come from the rules and not from the luck of the cards.
+// Shoe i is shuffled by its own generator, seeded from (seed, decks, i), so a shoe can be shuffled whenever it is
+// played, by whichever thread plays it, and the stream never has to be held in memory.
+class ShuffleStream
+{
+private:
+    int m_numDecks {};
+    std::uint32_t m_seed {};
+    std::vector<std::uint8_t> m_fresh {}; // card indices of an unshuffled shoe
+public:
+    ShuffleStream(int numDecks, std::uint32_t seed)
+        : m_numDecks { numDecks }
+        , m_seed { seed }
+        , m_fresh( static_cast<std::size_t>(numDecks) * 52 )
+    {
+        for (std::size_t i {0}; i < m_fresh.size(); ++i)
+            m_fresh[i] = static_cast<std::uint8_t>(i % 52);
+    }
+    std::size_t shoeSize() const { return m_fresh.size(); }
+    // Writes shoe `index` of the stream to order[0, shoeSize()):
+    void shoe(std::size_t index, std::uint8_t* order) const
+    {
+        std::seed_seq ss { m_seed, static_cast<std::uint32_t>(m_numDecks), static_cast<std::uint32_t>(index) };
+        std::mt19937 mt { ss };
+        std::copy(m_fresh.begin(), m_fresh.end(), order);
+        std::shuffle(order, order + m_fresh.size(), mt);
+    }
+    // The seed words a shoe was shuffled from (besides the deck count), packed into one number:
+    std::uint64_t shoeSeed(std::size_t index) const { return (static_cast<std::uint64_t>(m_seed) << 32) | index; }
+};
+// Running totals of the net result per hand, kept in exact integer units (Settings::unitsPerWager).
+// Integer sums don't depend on the order hands are added in, so a result never changes with the thread count.
+// (sumSquares has room for about 10^12 hands at a 2:1 payout.)
+struct Tally
+{
+    long long hands {0};
+    long long sum {0};
+    long long sumSquares {0};
+
+    void add(long long net)
+    {
+        ++hands;
+        sum += net;
+        sumSquares += net * net;
+    }
+    void merge(const Tally& other)
+    {
+        hands += other.hands;
+        sum += other.sum;
+        sumSquares += other.sumSquares;
+    }
+    // Floating point is only used for the final figures, in wagers:
+    double mean() const
+    {
+        return hands ? static_cast<double>(static_cast<long double>(sum) / (static_cast<long double>(hands) * Settings::unitsPerWager)) : 0.0;
+    }
+    double variance() const
+    {
+        if (!hands)
+            return 0.0;
+        const long double n { static_cast<long double>(hands) };
+        const long double units { static_cast<long double>(Settings::unitsPerWager) };
+        const long double mean { static_cast<long double>(sum) / n };
+        return static_cast<double>((static_cast<long double>(sumSquares) / n - mean * mean) / (units * units));
+    }
+};
+// Merges partial tallies pairwise in a fixed tree shape, decided by position in the list and never by
+// which thread finished first:
+Tally mergeTree(const Tally* parts, std::size_t count)
+{
+    if (count == 0)
+        return {};
+    if (count == 1)
+        return parts[0];
+    const std::size_t half { count / 2 };
+    Tally merged { mergeTree(parts, half) };
+    merged.merge(mergeTree(parts + half, count - half));
+    return merged;
+}
+struct SweepOptions
+{
+    std::vector<int> bustLimits { Settings::bustLimit };
+    std::vector<int> dealerLimits { Settings::dealerLimit };
+    std::vector<int> decks { Settings::numDecks };
+    std::vector<double> penetrations { Settings::penetration };
+    std::vector<double> winPayouts { Settings::winPayout };
+    std::vector<double> blackjackPayouts { Settings::blackjackPayout };
+    std::size_t shoes {20000}; // shoes played by each configuration
+    int seats {1};
+    int threads { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::uint32_t seed { static_cast<std::uint32_t>(Random::mt()) };
+    std::string historyPath {};  // hand histories are only written when this is set
+    bool historyDrop {false};    // drop records instead of waiting when the writer falls behind
+    std::size_t historyQueue {1 << 16};
+    bool progress {false};       // print live counters to stderr while the sweep runs
+    int procs {1};               // worker processes; each gets threads / procs threads
+    std::size_t procMemoryMb {0}; // address-space cap per worker process, 0 for none
+    std::string checkpointPath {}; // finished tasks are saved here every checkpointSeconds when this is set
+    int checkpointSeconds {60};
+    bool resume {false};          // start from the tasks already in checkpointPath
+};
+// Plays shoes [firstShoe, lastShoe) of the stream under one configuration.
+// Counters go to the worker's own Stats slot and are published every few thousand rounds:
+Tally playShoes(const Rules& rules, const Strategy::Tables& strategy, int seats, const ShuffleStream& stream,
+                std::size_t firstShoe, std::size_t lastShoe, std::uint16_t config, History::Writer* history,
+                Stats::Board& stats, int worker)
+{
+    constexpr int roundsPerPublish {4096};
+    int roundsUnpublished {0};
+    Table table {};
+    table.seatCount = seats;
+    Shoe shoe { rules };
+    std::vector<std::uint8_t> order( stream.shoeSize() );
+    std::array<Result,Settings::maxSeats> results {};
+    Tally tally {};
+
+    for (std::size_t index { firstShoe }; index < lastShoe; ++index)
+    {
+        stream.shoe(index, order.data());
+        shoe.load(order.data());
+        stats.add(worker, Stats::reshuffles);
+        for (std::uint32_t hand {0}; !shoe.cutCardReached(); ++hand)
+        {
+            playRound(table, shoe, rules, strategy, results);
+            stats.add(worker, Stats::aceSoftenings, static_cast<std::uint64_t>(table.softenings));
+            for (int seat {0}; seat < seats; ++seat)
+            {
+                tally.add(seatNet(table, seat, results[seat], rules));
+                stats.add(worker, Stats::hands);
+                stats.add(worker, results[seat] == Result::Win ? Stats::wins : results[seat] == Result::Tie ? Stats::ties : Stats::losses);
+                if (table.score[seat] > rules.bustLimit)
+                    stats.add(worker, Stats::busts);
+                if (history)
+                {
+                    History::HandRecord record { handRecord(table, seat, results[seat]) };
+                    record.seed = stream.shoeSeed(index);
+                    record.hand = hand;
+                    record.config = config;
+                    history->record(record);
+                }
+            }
+            if (++roundsUnpublished == roundsPerPublish)
+            {
+                stats.publish(worker);
+                roundsUnpublished = 0;
+            }
+        }
+    }
+    stats.publish(worker);
+    return tally;
+}
+// Prints one line of counters:
+void printCounts(std::ostream& out, const Stats::Counts& counts)
+{
+    for (int counter {0}; counter < Stats::maxCounter; ++counter)
+        out << (counter ? ", " : "") << counts[counter] << ' ' << Stats::counterName[counter];
+}
+// Prints a snapshot of the live counters to stderr about once a second until stopped:
+class ProgressMonitor
+{
+private:
+    const Stats::Board& m_stats;
+    std::mutex m_mutex {};
+    std::condition_variable m_wake {};
+    bool m_stopping {false};
+    std::thread m_thread {};
+
+    void run()
+    {
+        const auto start { std::chrono::steady_clock::now() };
+        std::unique_lock lock { m_mutex };
+        while (!m_wake.wait_for(lock, std::chrono::seconds{1}, [this] { return m_stopping; }))
+        {
+            const Stats::Counts counts { m_stats.snapshot() };
+            const std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+            std::cerr << '[' << std::fixed << std::setprecision(1) << elapsed.count() << "s, "
+                      << std::setprecision(2) << static_cast<double>(counts[Stats::hands]) / elapsed.count() / 1e6
+                      << "M hands/s] " << std::defaultfloat;
+            printCounts(std::cerr, counts);
+            std::cerr << '\n';
+        }
+    }
+
+public:
+    explicit ProgressMonitor(const Stats::Board& stats)
+        : m_stats { stats }
+        , m_thread { [this] { run(); } }
+    {
+    }
+    ~ProgressMonitor()
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+    ProgressMonitor(const ProgressMonitor&) = delete;
+    ProgressMonitor& operator=(const ProgressMonitor&) = delete;
+};
+// Checkpoints for long sweeps: the tasks finished so far, with their tallies and counters, under a fingerprint
+// of every option that decides the results. Each task replays its own shoes from the seeded shuffle stream, so
+// a resumed sweep only plays the missing tasks and prints exactly what an uninterrupted run would have printed.
+namespace Checkpoint
+{
+    constexpr std::uint32_t version {1};
+    struct Header
+    {
+        std::array<char,8> magic {'B','J','C','K','P','T','\0','\0'};
+        std::uint32_t version {Checkpoint::version};
+        std::uint32_t seed {};      // kept apart so --resume can pick up a seed that was drawn at random
+        std::uint64_t fingerprint {};
+        std::uint64_t tasks {};
+        std::uint64_t entries {};
+    };
+    struct Entry
+    {
+        std::uint64_t task {};
+        Tally tally {};
+        Stats::Counts counts {};
+    };
+    static_assert(std::is_trivially_copyable_v<Entry>);
+
+    // FNV-1a over the options that change what the sweep plays:
+    std::uint64_t fingerprint(const SweepOptions& options)
+    {
+        std::uint64_t hash { 0xcbf29ce484222325 };
+        auto mix { [&](const auto& value) {
+            const auto* bytes { reinterpret_cast<const unsigned char*>(&value) };
+            for (std::size_t i {0}; i < sizeof(value); ++i)
+                hash = (hash ^ bytes[i]) * 0x100000001b3;
+        } };
+        auto mixList { [&](const auto& values) {
+            mix(values.size());
+            for (const auto& value : values)
+                mix(value);
+        } };
+        mixList(options.bustLimits);
+        mixList(options.dealerLimits);
+        mixList(options.decks);
+        mixList(options.penetrations);
+        mixList(options.winPayouts);
+        mixList(options.blackjackPayouts);
+        mix(options.shoes);
+        mix(options.seats);
+        mix(options.seed);
+        return hash;
+    }
+
+    // Writes to a temporary file, syncs it and renames it into place, so the checkpoint on disk is always
+    // either the previous one or the new one, whenever the process is stopped:
+    bool save(const std::string& path, const Header& header, const std::vector<Entry>& entries)
+    {
+        const std::string temp { path + ".tmp" };
+        const int fd { ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) };
+        if (fd < 0)
+            return false;
+        auto writeAll { [fd](const void* data, std::size_t size) {
+            const char* bytes { static_cast<const char*>(data) };
+            while (size > 0)
+            {
+                const ssize_t wrote { ::write(fd, bytes, size) };
+                if (wrote <= 0)
+                    return false;
+                bytes += wrote;
+                size -= static_cast<std::size_t>(wrote);
+            }
+            return true;
+        } };
+        const bool written { writeAll(&header, sizeof(header)) && writeAll(entries.data(), entries.size() * sizeof(Entry))
+                             && ::fsync(fd) == 0 };
+        ::close(fd);
+        if (!written || std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+    // Reads just the header; false if the file is missing or isn't a checkpoint of this version.
+    bool readHeader(int fd, Header& header)
+    {
+        return ::read(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header))
+               && header.magic == Header{}.magic && header.version == version;
+    }
+    bool readHeader(const std::string& path, Header& header)
+    {
+        const int fd { ::open(path.c_str(), O_RDONLY) };
+        if (fd < 0)
+            return false;
+        const bool read { readHeader(fd, header) };
+        ::close(fd);
+        return read;
+    }
+    // Reads a checkpoint for the same options and task count; false if there is none or it belongs to another sweep.
+    bool load(const std::string& path, std::uint64_t fingerprint, std::size_t tasks, std::vector<Entry>& entries)
+    {
+        const int fd { ::open(path.c_str(), O_RDONLY) };
+        if (fd < 0)
+            return false;
+        Header header {};
+        bool loaded { readHeader(fd, header) && header.fingerprint == fingerprint && header.tasks == tasks
+                      && header.entries <= tasks };
+        if (loaded)
+        {
+            entries.resize(header.entries);
+            const auto size { static_cast<ssize_t>(entries.size() * sizeof(Entry)) };
+            loaded = ::read(fd, entries.data(), static_cast<std::size_t>(size)) == size;
+            for (const Entry& entry : entries)
+                loaded = loaded && entry.task < tasks;
+        }
+        ::close(fd);
+        return loaded;
+    }
+}
+// Saves the finished tasks of a running sweep every so often from its own thread. Workers only publish
+// a finished task by setting its flag, so writing a checkpoint never makes a worker wait.
+class Checkpointer
+{
+private:
+    const std::string& m_path;
+    const Checkpoint::Header m_header;
+    const std::vector<Tally>& m_tallies;
+    const std::vector<Stats::Counts>& m_counts;
+    const std::atomic<bool>* m_done;
+    const std::chrono::seconds m_interval;
+    std::mutex m_mutex {};
+    std::condition_variable m_wake {};
+    bool m_stopping {false};
+    std::thread m_thread {};
+
+    void run()
+    {
+        std::unique_lock lock { m_mutex };
+        while (!m_wake.wait_for(lock, m_interval, [this] { return m_stopping; }))
+            save();
+    }
+    void stop()
+    {
+        if (!m_thread.joinable())
+            return;
+        {
+            std::lock_guard lock { m_mutex };
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+    bool save() const
+    {
+        std::vector<Checkpoint::Entry> entries {};
+        for (std::size_t task {0}; task < m_tallies.size(); ++task)
+            if (m_done[task].load(std::memory_order_acquire))
+                entries.push_back(Checkpoint::Entry{ task, m_tallies[task], m_counts[task] });
+        Checkpoint::Header header { m_header };
+        header.entries = entries.size();
+        if (!Checkpoint::save(m_path, header, entries))
+        {
+            std::cerr << "Could not write the checkpoint " << m_path << ".\n";
+            return false;
+        }
+        return true;
+    }
+
+public:
+    Checkpointer(const std::string& path, const Checkpoint::Header& header, const std::vector<Tally>& tallies,
+                 const std::vector<Stats::Counts>& counts, const std::atomic<bool>* done, int seconds)
+        : m_path { path }
+        , m_header { header }
+        , m_tallies { tallies }
+        , m_counts { counts }
+        , m_done { done }
+        , m_interval { seconds }
+        , m_thread { [this] { run(); } }
+    {
+    }
+    ~Checkpointer() { stop(); }
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // Stops the thread, so nothing else is writing the checkpoint, then writes the last one:
+    bool finish()
+    {
+        stop();
+        return save();
+    }
+};
+// Process-parallel sweep: forks `procs` worker processes, each playing every procs-th task on its own thread pool.
+// Task tallies go straight into a shared anonymous mapping, where each worker also has its own slot for its
+// counters, and the parent merges them after every worker has exited. A worker that crashes or runs into its
+// memory cap only takes its own share down, and the parent reports it instead of printing partial results.
+using PlayTask = std::function<Tally(std::size_t task, Stats::Board& stats, int worker)>;
+bool runInProcesses(const SweepOptions& options, std::vector<Tally>& taskTallies, Stats::Counts& totals,
+                    const PlayTask& playTask)
+{
+    struct alignas(64) Slot
+    {
+        Stats::Counts counts {};
+        int finished {0};
+    };
+    const auto procs { static_cast<std::size_t>(options.procs) };
+    const std::size_t tasks { taskTallies.size() };
+    const std::size_t bytes { procs * sizeof(Slot) + tasks * sizeof(Tally) };
+    void* shared { ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0) };
+    if (shared == MAP_FAILED)
+    {
+        std::cerr << "Could not map " << bytes << " bytes of shared memory for the worker processes.\n";
+        return false;
+    }
+    Slot* slots { static_cast<Slot*>(shared) };
+    Tally* tallies { reinterpret_cast<Tally*>(static_cast<char*>(shared) + procs * sizeof(Slot)) };
+    for (std::size_t worker {0}; worker < procs; ++worker)
+        new (&slots[worker]) Slot{};
+    for (std::size_t task {0}; task < tasks; ++task)
+        new (&tallies[task]) Tally{};
+
+    const int threads { std::max(1, options.threads / options.procs) };
+    std::cout.flush(); // anything still buffered would otherwise be printed again by every child
+    std::cerr.flush();
+    std::vector<pid_t> children {};
+    for (std::size_t worker {0}; worker < procs; ++worker)
+    {
+        const pid_t pid { ::fork() };
+        if (pid < 0)
+        {
+            std::cerr << "Could not start worker process " << worker << ".\n";
+            break;
+        }
+        if (pid == 0)
+        {
+            // The child starts out with a copy of the parent's generators and stream count, so every child takes its
+            // own program seed before drawing, made from the sweep's seed and its worker number. Each of its threads
+            // then draws its own stream of that seed, and a replayed sweep reseeds them all the same way:
+            Random::setSeed((static_cast<std::uint64_t>(options.seed) << 32) | worker);
+            if (options.procMemoryMb > 0)
+            {
+                const rlim_t cap { static_cast<rlim_t>(options.procMemoryMb) << 20 };
+                const rlimit limit { cap, cap };
+                if (::setrlimit(RLIMIT_AS, &limit) != 0)
+                {
+                    std::cerr << "Worker process " << worker << " could not limit itself to " << options.procMemoryMb
+                              << " MB: " << std::strerror(errno) << ".\n";
+                    std::_Exit(1);
+                }
+            }
+
+            TaskPool pool { threads };
+            Stats::Board stats { pool.threads() };
+            std::vector<std::size_t> mine {};
+            for (std::size_t task { worker }; task < tasks; task += procs)
+                mine.push_back(task);
+            pool.run(mine.size(), [&](std::size_t index, int thread) {
+                tallies[mine[index]] = playTask(mine[index], stats, thread);
+            });
+            slots[worker].counts = stats.snapshot();
+            slots[worker].finished = 1;
+            std::_Exit(0); // the parent's destructors and atexit handlers are not the child's to run
+        }
+        children.push_back(pid);
+    }
+
+    bool succeeded { children.size() == procs };
+    for (std::size_t worker {0}; worker < children.size(); ++worker)
+    {
+        int status {0};
+        while (::waitpid(children[worker], &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        if (WIFSIGNALED(status))
+        {
+            std::cerr << "Worker process " << worker << " was killed by signal " << WTERMSIG(status) << ".\n";
+            succeeded = false;
+        }
+        else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !slots[worker].finished)
+        {
+            std::cerr << "Worker process " << worker << " did not finish.\n";
+            succeeded = false;
+        }
+    }
+    if (succeeded)
+    {
+        std::copy(tallies, tallies + tasks, taskTallies.begin());
+        for (std::size_t worker {0}; worker < procs; ++worker)
+            for (int counter {0}; counter < Stats::maxCounter; ++counter)
+                totals[counter] += slots[worker].counts[counter];
+    }
+    ::munmap(shared, bytes);
+    return succeeded;
+}
+bool runSweep(const SweepOptions& options)
+{
+    // Every combination of the option lists is one configuration:
+    std::vector<Rules> configs {};
+    for (int decks : options.decks)
+        for (int bust : options.bustLimits)
+            for (int dealer : options.dealerLimits)
+                for (double penetration : options.penetrations)
+                    for (double win : options.winPayouts)
+                        for (double blackjack : options.blackjackPayouts)
+                            configs.push_back(Rules{ bust, dealer, decks, penetration, win, blackjack });
+
+    TaskPool pool { options.threads };
+
+    // One set of strategy tables per (bust limit, dealer limit) pair, mapped from disk when already solved:
+    std::map<std::pair<int,int>, std::unique_ptr<Strategy::Handle>> strategies {};
+    for (const Rules& rules : configs)
+    {
+        auto& handle { strategies[{ rules.bustLimit, rules.dealerLimit }] };
+        if (!handle)
+            handle = std::make_unique<Strategy::Handle>(rules.bustLimit, rules.dealerLimit);
+    }
+
+    std::vector<ShuffleStream> streams {};
+    for (int decks : options.decks)
+        streams.emplace_back(decks, options.seed);
+    auto streamFor { [&](const Rules& rules) -> const ShuffleStream& {
+        auto found { std::find(options.decks.begin(), options.decks.end(), rules.numDecks) };
+        return streams[static_cast<std::size_t>(found - options.decks.begin())];
+    } };
+
+    // Each configuration is cut into blocks of shoes, so a slow configuration can be shared out by stealing.
+    // Every block keeps its own partial tally, so partials belong to blocks, not to threads:
+    constexpr std::size_t shoesPerTask {256};
+    const std::size_t tasksPerConfig { (options.shoes + shoesPerTask - 1) / shoesPerTask };
+    std::vector<Tally> taskTallies( configs.size() * tasksPerConfig );
+
+    std::unique_ptr<History::Writer> history {};
+    if (!options.historyPath.empty())
+    {
+        history = std::make_unique<History::Writer>(options.historyPath, options.historyQueue, options.historyDrop);
+        if (!history->isOpen())
+        {
+            std::cerr << "Could not open " << options.historyPath << " for hand histories.\n";
+            return false;
+        }
+    }
+
+    const PlayTask playTask { [&](std::size_t task, Stats::Board& stats, int worker) {
+        const Rules& rules { configs[task / tasksPerConfig] };
+        const std::size_t firstShoe { (task % tasksPerConfig) * shoesPerTask };
+        const std::size_t lastShoe { std::min(firstShoe + shoesPerTask, options.shoes) };
+        const Strategy::Tables& strategy { strategies.at({ rules.bustLimit, rules.dealerLimit })->tables() };
+        return playShoes(rules, strategy, options.seats, streamFor(rules), firstShoe, lastShoe,
+                         static_cast<std::uint16_t>(task / tasksPerConfig), history.get(), stats, worker);
+    } };
+
+    Stats::Counts totals {};
+    if (options.procs > 1)
+    {
+        if (!runInProcesses(options, taskTallies, totals, playTask))
+            return false;
+    }
+    else
+    {
+        // Every task's tally and counters are kept apart, so finished tasks can be checkpointed and resumed:
+        const std::size_t tasks { taskTallies.size() };
+        std::vector<Stats::Counts> taskCounts( tasks );
+        const auto taskDone { std::make_unique<std::atomic<bool>[]>(tasks) };
+        Checkpoint::Header header {};
+        header.seed = options.seed;
+        header.fingerprint = Checkpoint::fingerprint(options);
+        header.tasks = tasks;
+        if (options.resume)
+        {
+            std::vector<Checkpoint::Entry> entries {};
+            if (!Checkpoint::load(options.checkpointPath, header.fingerprint, tasks, entries))
+            {
+                std::cerr << options.checkpointPath << " is not a checkpoint of this sweep.\n";
+                return false;
+            }
+            for (const Checkpoint::Entry& entry : entries)
+            {
+                taskTallies[entry.task] = entry.tally;
+                taskCounts[entry.task] = entry.counts;
+                taskDone[entry.task].store(true, std::memory_order_relaxed);
+            }
+            std::cerr << "Resuming with " << entries.size() << " of " << tasks << " tasks done.\n";
+        }
+        std::vector<std::size_t> pending {};
+        for (std::size_t task {0}; task < tasks; ++task)
+            if (!taskDone[task].load(std::memory_order_relaxed))
+                pending.push_back(task);
+
+        Stats::Board stats { pool.threads() };
+        std::unique_ptr<ProgressMonitor> progress {};
+        if (options.progress)
+            progress = std::make_unique<ProgressMonitor>(stats);
+        std::unique_ptr<Checkpointer> checkpointer {};
+        if (!options.checkpointPath.empty())
+        {
+            checkpointer = std::make_unique<Checkpointer>(options.checkpointPath, header, taskTallies, taskCounts,
+                                                          taskDone.get(), options.checkpointSeconds);
+        }
+        pool.run(pending.size(), [&](std::size_t index, int worker) {
+            const std::size_t task { pending[index] };
+            const Stats::Counts before { stats.running(worker) };
+            taskTallies[task] = playTask(task, stats, worker);
+            const Stats::Counts& after { stats.running(worker) };
+            for (int counter {0}; counter < Stats::maxCounter; ++counter)
+                taskCounts[task][counter] = after[counter] - before[counter];
+            taskDone[task].store(true, std::memory_order_release);
+        });
+        progress.reset();
+        if (checkpointer && !checkpointer->finish()) // the last checkpoint holds every task
+            return false;
+        checkpointer.reset();
+        for (const Stats::Counts& counts : taskCounts)
+            for (int counter {0}; counter < Stats::maxCounter; ++counter)
+                totals[counter] += counts[counter];
+    }
+    if (history)
+        history->stop();
+
+    std::cout << configs.size() << " configurations, " << options.shoes << " shoes each, " << options.seats << " seat(s), ";
+    if (options.procs > 1)
+        std::cout << options.procs << " processes x " << std::max(1, options.threads / options.procs) << " threads";
+    else
+        std::cout << pool.threads() << " threads";
+    std::cout << ", seed " << options.seed << "\n\n";
+    std::cout << std::setw(5) << "bust" << std::setw(7) << "dealer" << std::setw(6) << "decks" << std::setw(6) << "pen"
+              << std::setw(6) << "win" << std::setw(6) << "bj" << std::setw(12) << "hands"
+              << std::setw(11) << "EV" << std::setw(10) << "variance" << std::setw(10) << "std err" << '\n';
+    std::cout << std::fixed;
+    for (std::size_t config {0}; config < configs.size(); ++config)
+    {
+        const Tally tally { mergeTree(taskTallies.data() + config * tasksPerConfig, tasksPerConfig) };
+
+        const Rules& rules { configs[config] };
+        const double stdErr { std::sqrt(tally.variance() / static_cast<double>(std::max(tally.hands, 1LL))) };
+        std::cout << std::setw(5) << rules.bustLimit << std::setw(7) << rules.dealerLimit << std::setw(6) << rules.numDecks
+                  << std::setw(6) << std::setprecision(2) << rules.penetration
+                  << std::setw(6) << rules.winPayout << std::setw(6) << rules.blackjackPayout
+                  << std::setw(12) << tally.hands
+                  << std::setw(11) << std::setprecision(5) << tally.mean()
+                  << std::setw(10) << std::setprecision(4) << tally.variance()
+                  << std::setw(10) << std::setprecision(5) << stdErr << '\n';
+    }
+    std::cout << std::defaultfloat << "\nTotals: ";
+    printCounts(std::cout, totals);
+    std::cout << '\n';
+
+    if (history)
+    {
+        const auto& queue { history->queue() };
+        std::cout << "\nHand history: " << history->written() << " records in " << history->writeCalls() << " writes to "
+                  << options.historyPath << ", " << queue.dropped() << " dropped, " << queue.stalls()
+                  << " producer stalls, queue high-water " << queue.highWater() << '/' << queue.capacity() << '\n';
+        if (history->written() > 0)
+        {
+            std::cout << "  " << history->bytes() << " bytes, " << std::setprecision(2) << std::fixed
+                      << static_cast<double>(history->bytes()) / static_cast<double>(history->written()) << " bytes per record ("
+                      << static_cast<double>(history->written() * sizeof(History::HandRecord)) / static_cast<double>(history->bytes())
+                      << "x smaller than raw records)\n" << std::defaultfloat;
+        }
+        if (history->error() != 0)
+        {
+            std::cout << "  Writing the hand history failed (" << std::strerror(history->error()) << "): "
+                      << history->lost() << " records lost\n";
+            return false;
+        }
+    }
+    return true;
+}
+// Prints the solved hit/stand chart for the default rules, hard totals first, then soft totals:
+void printStrategy()
+{
+    const Rules rules {};
+    const Strategy::Handle strategy { rules.bustLimit, rules.dealerLimit };
+    std::cout << "Strategy for bust limit " << rules.bustLimit << ", dealer limit " << rules.dealerLimit
+              << (strategy.mapped() ? " (mapped from " : " (solved, saved to ")
+              << Strategy::fileName(rules.bustLimit, rules.dealerLimit) << ")\n";
+    for (int soft {0}; soft < 2; ++soft)
+    {
+        std::cout << (soft ? "\nSoft" : "Hard") << "    2 3 4 5 6 7 8 9 T A\n";
+        for (int total { soft ? 12 : 4 }; total <= rules.bustLimit; ++total)
+        {
+            std::cout << std::setw(4) << total << "   ";
+            for (int upcard {2}; upcard <= 11; ++upcard)
+                std::cout << ' ' << (strategy.tables().wantHit(total, soft, upcard) ? 'H' : 'S');
+            std::cout << '\n';
+        }
+    }
+}
+// Decodes every block of a history file in parallel and prints a summary:
+int historyInfo(const std::string& path)
+{
+    const History::Reader reader { path };
+    if (!reader.isOpen())
+    {
+        std::cerr << path << " is not a hand history file.\n";
+        return 1;
+    }
+    TaskPool pool { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::vector<std::array<std::uint64_t,3>> blockResults( reader.blocks() );
+    pool.run(reader.blocks(), [&](std::size_t block, int) {
+        std::vector<History::HandRecord> records {};
+        reader.decode(block, records);
+        for (const auto& record : records)
+            ++blockResults[block][record.result];
+    });
+    std::array<std::uint64_t,3> results {};
+    for (const auto& counts : blockResults)
+        for (std::size_t result {0}; result < results.size(); ++result)
+            results[result] += counts[result];
+
+    std::cout << path << ": " << reader.records() << " records in " << reader.blocks() << " blocks, " << reader.bytes()
+              << " bytes (" << std::setprecision(2) << std::fixed
+              << static_cast<double>(reader.records() * sizeof(History::HandRecord)) / static_cast<double>(reader.bytes())
+              << "x smaller than raw records)\n" << std::defaultfloat;
+    std::cout << results[Result::Win] << " wins, " << results[Result::Tie] << " ties, " << results[Result::Lose] << " losses\n";
+    return 0;
+}
+// Turns a comma separated argument like "16,17,18" into a list of values:
+template <typename T>
+std::vector<T> parseList(std::string_view text)
+{
+    std::vector<T> values {};
+    while (!text.empty())
+    {
+        const std::size_t comma { text.find(',') };
+        const std::string item { text.substr(0, comma) };
+        if constexpr (std::is_floating_point_v<T>)
+            values.push_back(static_cast<T>(std::stod(item)));
+        else
+        {
+            // A value T can't hold would otherwise wrap (--shoes -1 becoming SIZE_MAX); throwing gets the usage message:
+            const long long value { std::stoll(item) };
+            const bool fits { std::is_unsigned_v<T>
+                              ? value >= 0 && static_cast<unsigned long long>(value) <= std::numeric_limits<T>::max()
+                              : value >= static_cast<long long>(std::numeric_limits<T>::min())
+                                && value <= static_cast<long long>(std::numeric_limits<T>::max()) };
+            if (!fits)
+                throw std::out_of_range { item };
+            values.push_back(static_cast<T>(value));
+        }
+        text = (comma == std::string_view::npos) ? std::string_view{} : text.substr(comma + 1);
+    }
+    return values;
+}
+int sweepUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " --sweep [--bust 21,22] [--dealer 16,17] [--decks 1,6] [--pen 0.5,0.75]\n"
+              << "       [--win 1] [--bj 1.5,1.2] [--shoes N] [--seats N] [--threads N] [--seed N]\n"
+              << "       [--history FILE] [--history-drop] [--history-queue N] [--progress]\n"
+              << "       [--procs N] [--proc-memory MB]   (worker processes share --threads between them;\n"
+              << "                                         not with --history, --progress or --checkpoint)\n"
+              << "       [--checkpoint FILE] [--checkpoint-every SECONDS] [--resume]\n";
+    return 1;
+}
+// Parses the options after --sweep and runs the sweep:
+int sweepMain(int argc, char* argv[])
+{
+    SweepOptions options {};
+    try
+    {
+        for (int arg {2}; arg < argc; ++arg)
+        {
+            const std::string_view name { argv[arg] };
+            if (name == "--history-drop")
+            {
+                options.historyDrop = true;
+                continue;
+            }
+            if (name == "--progress")
+            {
+                options.progress = true;
+                continue;
+            }
+            if (name == "--resume")
+            {
+                options.resume = true;
+                continue;
+            }
+            if (++arg >= argc)
+                return sweepUsage(argv[0]);
+            const std::string_view value { argv[arg] };
+
+            if (name == "--bust")         options.bustLimits = parseList<int>(value);
+            else if (name == "--dealer")  options.dealerLimits = parseList<int>(value);
+            else if (name == "--decks")   options.decks = parseList<int>(value);
+            else if (name == "--pen")     options.penetrations = parseList<double>(value);
+            else if (name == "--win")     options.winPayouts = parseList<double>(value);
+            else if (name == "--bj")      options.blackjackPayouts = parseList<double>(value);
+            else if (name == "--shoes")   options.shoes = parseList<std::size_t>(value).at(0);
+            else if (name == "--seats")   options.seats = parseList<int>(value).at(0);
+            else if (name == "--threads") options.threads = parseList<int>(value).at(0);
+            else if (name == "--seed")    options.seed = parseList<std::uint32_t>(value).at(0);
+            else if (name == "--history") options.historyPath = value;
+            else if (name == "--history-queue") options.historyQueue = parseList<std::size_t>(value).at(0);
+            else if (name == "--procs")   options.procs = parseList<int>(value).at(0);
+            else if (name == "--proc-memory") options.procMemoryMb = parseList<std::size_t>(value).at(0);
+            else if (name == "--checkpoint") options.checkpointPath = value;
+            else if (name == "--checkpoint-every") options.checkpointSeconds = parseList<int>(value).at(0);
+            else return sweepUsage(argv[0]);
+        }
+    }
+    catch (const std::exception&) // std::stoll and friends throw on bad numbers
+    {
+        return sweepUsage(argv[0]);
+    }
+
+    for (int decks : options.decks)
+        if (decks < 1)
+            return sweepUsage(argv[0]);
+    for (double penetration : options.penetrations)
+        if (penetration <= 0.0 || penetration > 1.0)
+            return sweepUsage(argv[0]);
+    for (int bust : options.bustLimits)
+        for (int dealer : options.dealerLimits)
+            if (bust < 2 || bust >= Strategy::maxTotal || dealer < 2 || dealer > bust)
+                return sweepUsage(argv[0]);
+    const std::size_t queue { options.historyQueue };
+    if (queue < 2 || (queue & (queue - 1)) != 0) // the queue needs a power of two
+        return sweepUsage(argv[0]);
+    if (options.seats < 1 || options.seats > Settings::maxSeats || options.shoes < 1 || options.threads < 1)
+        return sweepUsage(argv[0]);
+    // Worker processes can't feed the parent's history writer, its live counters or its checkpoints:
+    if (options.procs < 1 || (options.procs > 1 && (!options.historyPath.empty() || options.progress || !options.checkpointPath.empty())))
+        return sweepUsage(argv[0]);
+    // Resuming needs a checkpoint, and a hand history can't be resumed halfway:
+    if (options.checkpointSeconds < 1 || (options.resume && (options.checkpointPath.empty() || !options.historyPath.empty())))
+        return sweepUsage(argv[0]);
+    if (options.resume)
+    {
+        // The shoes have to be shuffled from the interrupted run's seed:
+        Checkpoint::Header header {};
+        if (!Checkpoint::readHeader(options.checkpointPath, header))
+        {
+            std::cerr << "Could not read the checkpoint " << options.checkpointPath << ".\n";
+            return 1;
+        }
+        options.seed = header.seed;
+    }
+
+    return runSweep(options) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Simulation Mode: main --table <seats> <rounds> [--side-bets]
+    if (argc > 1 && std::string_view{argv[1]} == "--table")
+    {
+        auto usage { [&] {
+            std::cerr << "Usage: " << argv[0] << " --table <seats 1-" << Settings::maxSeats << "> <rounds> [--side-bets]\n"
+                      << "       (RANDOM_SEED=N in the environment replays the run that reported seed N)\n";
+            return 1;
+        } };
+        int seats {};
+        long long rounds {};
+        try
+        {
+            seats = argc > 2 ? std::stoi(argv[2]) : Settings::maxSeats;
+            rounds = argc > 3 ? std::stoll(argv[3]) : 100000;
+        }
+        catch (const std::exception&) // std::stoi and friends throw on bad numbers
+        {
+            return usage();
+        }
+        const bool sideBets { argc > 4 && std::string_view{argv[4]} == "--side-bets" };
+        if (seats < 1 || seats > Settings::maxSeats || rounds < 1 || (argc > 4 && !sideBets))
+            return usage();
+        simulateTable(seats, rounds, sideBets);
+        return 0;
+    }
+    // Side Bet Odds: main --side-bets [decks]
+    if (argc > 1 && std::string_view{argv[1]} == "--side-bets")
+    {
+        auto usage { [&] {
+            std::cerr << "Usage: " << argv[0] << " --side-bets [decks]\n";
+            return 1;
+        } };
+        int decks {};
+        try
+        {
+            decks = argc > 2 ? std::stoi(argv[2]) : Settings::numDecks;
+        }
+        catch (const std::exception&)
+        {
+            return usage();
+        }
+        if (decks < 1)
+            return usage();
+        return sideBetOdds(decks);
+    }
+    // Allocation Check: main --alloc-check [rounds]
+    if (argc > 1 && std::string_view{argv[1]} == "--alloc-check")
+    {
+        auto usage { [&] {
+            std::cerr << "Usage: " << argv[0] << " --alloc-check [rounds]\n";
+            return 1;
+        } };
+        long long rounds {};
+        try
+        {
+            rounds = argc > 2 ? std::stoll(argv[2]) : 100000;
+        }
+        catch (const std::exception&)
+        {
+            return usage();
+        }
+        if (rounds < 1)
+            return usage();
+        return allocCheck(rounds);
+    }
+    // Strategy Chart: main --strategy
+    if (argc > 1 && std::string_view{argv[1]} == "--strategy")
+    {
+        printStrategy();
+        return 0;
+    }
+    // History Summary: main --history-info <file>
+    if (argc > 2 && std::string_view{argv[1]} == "--history-info")
+    {
+        return historyInfo(argv[2]);
+    }
+    // Rule Sweep Mode: main --sweep [options], see sweepUsage()
+    if (argc > 1 && std::string_view{argv[1]} == "--sweep")
+    {
+        return sweepMain(argc, argv);
+    }
+    // Scripted Game: main --script <file or - for stdin>
+    // Plays hand after hand through the interactive game, taking the decisions from the script, until it runs out.
+    if (argc > 2 && std::string_view{argv[1]} == "--script")
+    {
+        DecisionReader script { argv[2] };
+        if (!script.isOpen())
+        {
+            std::cerr << "Could not open " << argv[2] << " for decisions.\n";
+            return 1;
+        }
+        std::array<long long,3> results {}; // indexed by Result
+        while (script.more())
+        {
+            const Result result { playBlackJack(&script) };
+            transcript << (result == Result::Win ? "You win\n" : result == Result::Lose ? "You Lose!\n" : "Tie!\n");
+            transcript.endHand();
+            ++results[result];
+        }
+        transcript.flush(); // before the summary goes out through std::cout
+        std::cout << results[Result::Win] + results[Result::Tie] + results[Result::Lose] << " hands: "
+                  << results[Result::Win] << " wins, " << results[Result::Tie] << " ties, "
+                  << results[Result::Lose] << " losses (random seed " << Random::seedUsed() << ")\n";
+        return 0;
+    }
     // Black Jack Game: 
     Result resultOfGame {playBlackJack()};
     if( resultOfGame == Result::Win )
     {
-        std::cout << "You win\n";  
+        transcript << "You win\n";
     }
     else if( resultOfGame == Result::Lose ) 
     {
-        std::cout << "You Lose!\n";
+        transcript << "You Lose!\n";
     }
     else
     {
-        std::cout << "Tie!\n";
+        transcript << "Tie!\n";
     }
+    transcript.flush();
+    std::cout << "(random seed " << Random::seedUsed() << ")\n";
 
 
     return 0;
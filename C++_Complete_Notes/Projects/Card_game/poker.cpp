@@ -0,0 +1,382 @@
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+#include "Card.h"
+#include "Deck.h"
+#include "Poker.h"
+#include "TaskPool.h"
+
+// Texas Hold'em on the same Card, Deck and Random foundation as the Black-Jack game.
+//
+//   poker bench                                        scores every 5 and 7 card hand and checks the counts
+//   poker equity AsKs QdQh [...] [--board 2c7d9h] [--threads N]
+//   poker deal [players]                               deals a random hand and shows the equity on each street
+//
+// Equity is exact: every way to complete the board is dealt out and each player's share of the pot is counted.
+
+constexpr int maxPlayers {9};
+
+// Reads a card written like "As", "Td" or "AS" (the way Card prints):
+bool parseCard(std::string_view text, Card& card)
+{
+    constexpr std::string_view ranks {"A23456789TJQK"};
+    constexpr std::string_view suits {"CDHS"};
+    if (text.size() != 2)
+        return false;
+    const std::size_t rank { ranks.find(static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])))) };
+    const std::size_t suit { suits.find(static_cast<char>(std::toupper(static_cast<unsigned char>(text[1])))) };
+    if (rank == std::string_view::npos || suit == std::string_view::npos)
+        return false;
+    card = Card{ Card::allRank[rank], Card::allSuits[suit] };
+    return true;
+}
+// Reads a run of cards like "2c7d9h":
+bool parseCards(std::string_view text, std::vector<Card>& cards)
+{
+    if (text.size() % 2 != 0)
+        return false;
+    for (std::size_t at {0}; at < text.size(); at += 2)
+    {
+        Card card {};
+        if (!parseCard(text.substr(at, 2), card))
+            return false;
+        cards.push_back(card);
+    }
+    return true;
+}
+
+struct Equity
+{
+    std::uint64_t boards {0};
+    std::array<std::uint64_t,maxPlayers> wins {};
+    std::array<std::uint64_t,maxPlayers> ties {};
+    std::array<double,maxPlayers> share {}; // pots won, counting a split pot as a fraction
+
+    void merge(const Equity& other)
+    {
+        boards += other.boards;
+        for (int player {0}; player < maxPlayers; ++player)
+        {
+            wins[player] += other.wins[player];
+            ties[player] += other.ties[player];
+            share[player] += other.share[player];
+        }
+    }
+};
+
+// Shows down one complete board:
+void showdown(const std::vector<Poker::Hand>& holes, Poker::Hand board, Equity& equity)
+{
+    std::array<Poker::Score,maxPlayers> scores {};
+    Poker::Score best {0};
+    int winners {0};
+    for (std::size_t player {0}; player < holes.size(); ++player)
+    {
+        scores[player] = Poker::evaluate(holes[player] | board);
+        if (scores[player] > best)
+        {
+            best = scores[player];
+            winners = 1;
+        }
+        else if (scores[player] == best)
+        {
+            ++winners;
+        }
+    }
+    ++equity.boards;
+    for (std::size_t player {0}; player < holes.size(); ++player)
+    {
+        if (scores[player] != best)
+            continue;
+        if (winners == 1)
+        {
+            ++equity.wins[player];
+        }
+        else
+        {
+            ++equity.ties[player];
+            equity.share[player] += 1.0 / winners;
+        }
+    }
+}
+// Deals every remaining `needed` cards from cards[from...] onto the board:
+void forEachBoard(const std::vector<Poker::Hand>& cards, std::size_t from, int needed, Poker::Hand board,
+                  const std::vector<Poker::Hand>& holes, Equity& equity)
+{
+    if (needed == 0)
+    {
+        showdown(holes, board, equity);
+        return;
+    }
+    for (std::size_t card { from }; card + static_cast<std::size_t>(needed) <= cards.size(); ++card)
+        forEachBoard(cards, card + 1, needed - 1, board | cards[card], holes, equity);
+}
+
+// Exact all-in equity: the boards are split into tasks by their first two cards, so there are enough tasks
+// to balance across cores. Every task keeps its own partial result and the partials are merged in task order.
+Equity allInEquity(const std::vector<Poker::Hand>& holes, const std::vector<Card>& boardCards, TaskPool& pool)
+{
+    Poker::Hand dead {0};
+    Poker::Hand board {0};
+    for (Poker::Hand hole : holes)
+        dead |= hole;
+    for (const Card& card : boardCards)
+        board |= Poker::cardMask(card);
+    dead |= board;
+
+    std::vector<Poker::Hand> cards {};
+    for (Poker::Hand mask : Poker::cardMasks)
+        if (!(dead & mask))
+            cards.push_back(mask);
+
+    const int needed { 5 - static_cast<int>(boardCards.size()) };
+    const int dealtUpFront { std::min(needed, 2) };
+    struct Task
+    {
+        Poker::Hand board {};
+        std::size_t from {};
+    };
+    std::vector<Task> tasks {};
+    if (dealtUpFront == 0)
+    {
+        tasks.push_back(Task{ board, cards.size() });
+    }
+    else
+    {
+        for (std::size_t first {0}; first < cards.size(); ++first)
+        {
+            if (dealtUpFront == 1)
+            {
+                tasks.push_back(Task{ board | cards[first], first + 1 });
+                continue;
+            }
+            for (std::size_t second { first + 1 }; second < cards.size(); ++second)
+                tasks.push_back(Task{ board | cards[first] | cards[second], second + 1 });
+        }
+    }
+
+    std::vector<Equity> partials( tasks.size() );
+    pool.run(tasks.size(), [&](std::size_t task, int) {
+        forEachBoard(cards, tasks[task].from, needed - dealtUpFront, tasks[task].board, holes, partials[task]);
+    });
+    Equity equity {};
+    for (const Equity& partial : partials)
+        equity.merge(partial);
+    return equity;
+}
+void printEquity(const std::vector<std::vector<Card>>& players, const Equity& equity)
+{
+    std::cout << std::fixed;
+    for (std::size_t player {0}; player < players.size(); ++player)
+    {
+        std::cout << "  " << players[player][0] << players[player][1] << "  equity "
+                  << std::setw(7) << std::setprecision(3)
+                  << 100.0 * (static_cast<double>(equity.wins[player]) + equity.share[player]) / static_cast<double>(equity.boards)
+                  << "%  win " << std::setw(7)
+                  << 100.0 * static_cast<double>(equity.wins[player]) / static_cast<double>(equity.boards)
+                  << "%  tie " << std::setw(7)
+                  << 100.0 * static_cast<double>(equity.ties[player]) / static_cast<double>(equity.boards) << "%\n";
+    }
+    std::cout << std::defaultfloat << "  (" << equity.boards << " boards)\n";
+}
+
+// Scores every 5-card and every 7-card hand from a 52 card deck, building the hands one OR at a time,
+// and checks the number of hands in each category against the published counts:
+int bench()
+{
+    constexpr std::array<std::uint64_t,Poker::maxCategory> fiveCardCounts {
+        1302540, 1098240, 123552, 54912, 10200, 5108, 3744, 624, 40
+    };
+    constexpr std::array<std::uint64_t,Poker::maxCategory> sevenCardCounts {
+        23294460, 58627800, 31433400, 6461620, 6180020, 4047644, 3473184, 224848, 41584
+    };
+    const auto& mask { Poker::cardMasks };
+
+    std::array<std::uint64_t,Poker::maxCategory> five {};
+    for (int a {0}; a < 52; ++a)
+        for (int b { a + 1 }; b < 52; ++b)
+            for (int c { b + 1 }; c < 52; ++c)
+                for (int d { c + 1 }; d < 52; ++d)
+                    for (int e { d + 1 }; e < 52; ++e)
+                        ++five[Poker::category(Poker::evaluate(mask[a] | mask[b] | mask[c] | mask[d] | mask[e]))];
+
+    std::array<std::uint64_t,Poker::maxCategory> seven {};
+    const auto start { std::chrono::steady_clock::now() };
+    for (int a {0}; a < 52; ++a)
+    {
+        const Poker::Hand handA { mask[a] };
+        for (int b { a + 1 }; b < 52; ++b)
+        {
+            const Poker::Hand handB { handA | mask[b] };
+            for (int c { b + 1 }; c < 52; ++c)
+            {
+                const Poker::Hand handC { handB | mask[c] };
+                for (int d { c + 1 }; d < 52; ++d)
+                {
+                    const Poker::Hand handD { handC | mask[d] };
+                    for (int e { d + 1 }; e < 52; ++e)
+                    {
+                        const Poker::Hand handE { handD | mask[e] };
+                        for (int f { e + 1 }; f < 52; ++f)
+                        {
+                            const Poker::Hand handF { handE | mask[f] };
+                            for (int g { f + 1 }; g < 52; ++g)
+                                ++seven[Poker::category(Poker::evaluate(handF | mask[g]))];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    const std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+
+    bool correct {true};
+    std::cout << std::setw(16) << "category" << std::setw(12) << "5 cards" << std::setw(12) << "7 cards" << '\n';
+    std::uint64_t hands {0};
+    for (int category {0}; category < Poker::maxCategory; ++category)
+    {
+        std::cout << std::setw(16) << Poker::categoryName[category] << std::setw(12) << five[category]
+                  << std::setw(12) << seven[category] << '\n';
+        correct = correct && five[category] == fiveCardCounts[category] && seven[category] == sevenCardCounts[category];
+        hands += seven[category];
+    }
+    std::cout << hands << " seven-card hands in " << std::setprecision(3) << elapsed.count() << "s on one thread, "
+              << static_cast<double>(hands) / elapsed.count() / 1e6 << "M hands/s\n";
+    if (!correct)
+    {
+        std::cerr << "Category counts don't match the published totals.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Deals a random Hold'em hand from a shuffled Deck and shows everyone's equity before the flop, on the flop,
+// on the turn and at the river:
+void deal(int players, TaskPool& pool)
+{
+    StandardDeck deck {};
+    deck.shuffle();
+    std::vector<std::vector<Card>> hands( static_cast<std::size_t>(players) );
+    for (int round {0}; round < 2; ++round)
+        for (auto& hand : hands)
+            hand.push_back(deck.dealCard());
+    std::vector<Poker::Hand> holes {};
+    for (const auto& hand : hands)
+        holes.push_back(Poker::cardMask(hand[0]) | Poker::cardMask(hand[1]));
+
+    std::vector<Card> board {};
+    constexpr std::array<std::string_view,4> streets { "Preflop", "Flop", "Turn", "River" };
+    for (std::size_t street {0}; street < streets.size(); ++street)
+    {
+        while (board.size() < (street == 0 ? 0u : street + 2))
+            board.push_back(deck.dealCard());
+        std::cout << streets[street] << ' ';
+        for (const Card& card : board)
+            std::cout << card << ' ';
+        std::cout << '\n';
+        printEquity(hands, allInEquity(holes, board, pool));
+    }
+
+    Poker::Hand table {0};
+    for (const Card& card : board)
+        table |= Poker::cardMask(card);
+    for (std::size_t player {0}; player < hands.size(); ++player)
+        std::cout << hands[player][0] << hands[player][1] << ": "
+                  << Poker::categoryName[Poker::category(Poker::evaluate(holes[player] | table))] << '\n';
+}
+
+int usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " bench\n"
+              << "       " << program << " equity AsKs QdQh [...] [--board 2c7d9h] [--threads N]\n"
+              << "       " << program << " deal [players 2-" << maxPlayers << "] [--threads N]\n";
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return usage(argv[0]);
+    const std::string_view command { argv[1] };
+    if (command == "bench")
+        return bench();
+
+    int threads { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::vector<std::vector<Card>> players {};
+    std::vector<Card> board {};
+    int dealPlayers {2};
+    try
+    {
+        for (int arg {2}; arg < argc; ++arg)
+        {
+            const std::string_view text { argv[arg] };
+            if (text == "--threads" && arg + 1 < argc)
+                threads = std::stoi(argv[++arg]);
+            else if (text == "--board" && arg + 1 < argc && command == "equity")
+            {
+                if (!parseCards(argv[++arg], board))
+                    return usage(argv[0]);
+            }
+            else if (command == "deal")
+                dealPlayers = std::stoi(argv[arg]);
+            else
+            {
+                std::vector<Card> hole {};
+                if (!parseCards(text, hole) || hole.size() != 2)
+                    return usage(argv[0]);
+                players.push_back(hole);
+            }
+        }
+    }
+    catch (const std::exception&) // std::stoi throws on bad numbers
+    {
+        return usage(argv[0]);
+    }
+    if (threads < 1)
+        return usage(argv[0]);
+    TaskPool pool { threads };
+
+    if (command == "deal")
+    {
+        if (dealPlayers < 2 || dealPlayers > maxPlayers)
+            return usage(argv[0]);
+        deal(dealPlayers, pool);
+        return 0;
+    }
+    if (command != "equity" || players.size() < 2 || players.size() > maxPlayers || board.size() > 5 || board.size() == 1
+        || board.size() == 2)
+        return usage(argv[0]);
+
+    // Every card may only appear once:
+    Poker::Hand seen {0};
+    std::vector<Poker::Hand> holes {};
+    for (const auto& hole : players)
+    {
+        const Poker::Hand hand { Poker::cardMask(hole[0]) | Poker::cardMask(hole[1]) };
+        if ((seen & hand) || hole[0].index() == hole[1].index())
+            return usage(argv[0]);
+        seen |= hand;
+        holes.push_back(hand);
+    }
+    for (const Card& card : board)
+    {
+        if (seen & Poker::cardMask(card))
+            return usage(argv[0]);
+        seen |= Poker::cardMask(card);
+    }
+
+    const auto start { std::chrono::steady_clock::now() };
+    const Equity equity { allInEquity(holes, board, pool) };
+    const std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+    printEquity(players, equity);
+    std::cout << "  " << std::setprecision(3) << elapsed.count() << "s on " << pool.threads() << " threads\n";
+    return 0;
+}
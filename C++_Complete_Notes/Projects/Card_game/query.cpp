@@ -0,0 +1,545 @@
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <immintrin.h> // AVX2 intrinsics, only used on CPUs that have them
+#include "Card.h"
+#include "HandHistory.h"
+#include "TaskPool.h"
+
+// Query tool for hand-history files written by `main --sweep --history FILE`.
+//
+//   query index FILE                builds FILE.idx
+//   query FILE [--config 0] [--up T] [--total 16] [--soft | --hard] [--threads N]
+//
+// Answers questions like "win rate when the dealer shows T and the player starts on hard 16" from bitmap indexes
+// instead of decoding every hand. For each block of the history file, the index keeps one bitmap (a bit per record)
+// for every dealer upcard, starting total, result and sweep configuration present in the block, plus one for soft
+// starts. A sweep plays several rule sets, so --config picks one (configurations are numbered from 0, in the order
+// of the sweep's results table); without it the counts are pooled over all of them.
+// A query ANDs the bitmaps it needs and counts the bits left under each result bitmap. Blocks are queried
+// in parallel, and the AND/popcount loops use AVX2 when the CPU has it.
+
+namespace Index
+{
+    using Word = std::uint64_t;
+    constexpr int upcards {10}; // upcard values 2-11
+    constexpr int totals {32};
+
+    struct Header
+    {
+        std::array<char,8> magic {'B','J','H','I','D','X','\0','\0'};
+        std::uint32_t version {3};
+        std::uint32_t blockRecords {};
+        std::uint64_t blocks {};
+        // The history file it was built from, to notice a stale index:
+        std::uint64_t historyBytes {};
+        std::uint64_t historyRecords {};
+        std::uint64_t historyHash {};  // of the history's block size and block index
+        std::uint64_t tableOffset {};  // where the Block table starts (after all the bitmaps)
+        std::uint64_t configs {};      // distinct sweep configurations in the history
+    };
+    // What an index remembers of its history file. A rewritten history of the same size still has its own
+    // block index, since block sizes follow the compressed contents:
+    struct Fingerprint
+    {
+        std::uint64_t bytes {};
+        std::uint64_t records {};
+        std::uint64_t hash {};
+    };
+    Fingerprint fingerprint(const History::Reader& reader)
+    {
+        std::uint64_t hash { 0xcbf29ce484222325 }; // FNV-1a
+        auto mix { [&](const auto& value) {
+            const auto* bytes { reinterpret_cast<const unsigned char*>(&value) };
+            for (std::size_t i {0}; i < sizeof(value); ++i)
+                hash = (hash ^ bytes[i]) * 0x100000001b3;
+        } };
+        mix(reader.blockRecords());
+        for (std::size_t block {0}; block < reader.blocks(); ++block)
+            mix(reader.block(block));
+        return { reader.bytes(), reader.records(), hash };
+    }
+    // Which bitmaps a block has (bit n set = a bitmap for value n is stored) and where they start.
+    // Bitmaps are stored in this order: soft, then upcards, then totals, then results, each in ascending value order,
+    // then one per configuration in the block. The configurations' numbers follow as a sorted uint16 list padded to a word.
+    struct Block
+    {
+        std::uint32_t records {};
+        std::uint32_t upcards {};
+        std::uint32_t totals {};
+        std::uint32_t results {};
+        std::uint32_t configs {}; // how many configurations the block has
+        std::uint32_t reserved {};
+        std::uint64_t offset {};
+    };
+    constexpr std::size_t configListWords(std::uint32_t configs) { return (configs + 3) / 4; }
+
+    int upcardValue(const History::HandRecord& record)
+    {
+        return Card::fromIndex(record.dealerCards[0]).val();
+    }
+
+    // Builds the bitmaps for one decoded block: returns the Block entry (offset left at 0) and appends the words.
+    Block buildBlock(const std::vector<History::HandRecord>& records, int words, std::vector<Word>& out)
+    {
+        std::vector<Word> soft( words );
+        std::array<std::vector<Word>,upcards> byUpcard {};
+        std::array<std::vector<Word>,totals> byTotal {};
+        std::array<std::vector<Word>,History::maxRecordResult> byResult {};
+        std::map<std::uint16_t,std::vector<Word>> byConfig {};
+        Block block {};
+        block.records = static_cast<std::uint32_t>(records.size());
+
+        auto set { [&](std::vector<Word>& bitmap, std::size_t bit) {
+            if (bitmap.empty())
+                bitmap.resize(static_cast<std::size_t>(words));
+            bitmap[bit / 64] |= Word{1} << (bit % 64);
+        } };
+        for (std::size_t i {0}; i < records.size(); ++i)
+        {
+            const History::HandRecord& record { records[i] };
+            const int up { upcardValue(record) - 2 };
+            const int total { std::min<int>(record.startTotal, totals - 1) };
+            if (record.soft)
+                set(soft, i);
+            set(byUpcard[up], i);
+            set(byTotal[total], i);
+            set(byResult[record.result], i);
+            set(byConfig[record.config], i);
+            block.upcards |= 1u << up;
+            block.totals |= 1u << total;
+            block.results |= 1u << record.result;
+        }
+
+        out.insert(out.end(), soft.begin(), soft.end());
+        for (const auto& bitmap : byUpcard)
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
+        for (const auto& bitmap : byTotal)
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
+        for (const auto& bitmap : byResult)
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
+        for (const auto& [config, bitmap] : byConfig)
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
+        block.configs = static_cast<std::uint32_t>(byConfig.size());
+        std::vector<std::uint16_t> list( configListWords(block.configs) * 4 );
+        std::size_t next {0};
+        for (const auto& entry : byConfig)
+            list[next++] = entry.first;
+        const std::size_t at { out.size() };
+        out.resize(at + configListWords(block.configs));
+        std::memcpy(out.data() + at, list.data(), list.size() * sizeof(std::uint16_t));
+        return block;
+    }
+
+    std::string pathFor(const std::string& history) { return history + ".idx"; }
+
+    // Decodes the history file in parallel, a batch of blocks at a time, and writes the index next to it.
+    bool build(const std::string& historyPath, TaskPool& pool)
+    {
+        const History::Reader reader { historyPath };
+        if (!reader.isOpen())
+            return false;
+        const std::uint32_t blockRecords { reader.blockRecords() };
+        if (blockRecords == 0 || blockRecords % 64 != 0)
+            return false;
+        const int words { static_cast<int>(blockRecords / 64) };
+
+        const std::string path { pathFor(historyPath) };
+        const std::string temp { path + ".tmp" };
+        std::FILE* file { std::fopen(temp.c_str(), "wb") };
+        if (!file)
+            return false;
+
+        Header header {};
+        header.blockRecords = blockRecords;
+        header.blocks = reader.blocks();
+        const Fingerprint history { fingerprint(reader) };
+        header.historyBytes = history.bytes;
+        header.historyRecords = history.records;
+        header.historyHash = history.hash;
+        std::fwrite(&header, sizeof(header), 1, file); // rewritten at the end, once tableOffset is known
+        std::uint64_t offset { sizeof(header) };
+
+        std::vector<Block> table( reader.blocks() );
+        constexpr std::size_t batch {256};
+        std::vector<std::vector<Word>> bitmaps( batch );
+        std::vector<std::uint8_t> seenConfig( 65536 );
+        for (std::size_t first {0}; first < reader.blocks(); first += batch)
+        {
+            const std::size_t count { std::min(batch, reader.blocks() - first) };
+            pool.run(count, [&](std::size_t i, int) {
+                std::vector<History::HandRecord> records {};
+                reader.decode(first + i, records);
+                bitmaps[i].clear();
+                table[first + i] = buildBlock(records, words, bitmaps[i]);
+            });
+            for (std::size_t i {0}; i < count; ++i)
+            {
+                table[first + i].offset = offset;
+                const std::uint32_t configs { table[first + i].configs };
+                const auto* list { reinterpret_cast<const std::uint16_t*>(bitmaps[i].data() + bitmaps[i].size() - configListWords(configs)) };
+                for (std::uint32_t c {0}; c < configs; ++c)
+                    header.configs += !std::exchange(seenConfig[list[c]], std::uint8_t{1});
+                std::fwrite(bitmaps[i].data(), sizeof(Word), bitmaps[i].size(), file);
+                offset += bitmaps[i].size() * sizeof(Word);
+            }
+        }
+        header.tableOffset = offset;
+        std::fwrite(table.data(), sizeof(Block), table.size(), file);
+        std::fseek(file, 0, SEEK_SET);
+        std::fwrite(&header, sizeof(header), 1, file);
+        const bool ok { std::ferror(file) == 0 };
+        std::fclose(file);
+        return ok && std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+
+    // The index file, mapped read-only.
+    class File
+    {
+    private:
+        const std::uint8_t* m_data {nullptr};
+        std::size_t m_size {0};
+        Header m_header {};
+    public:
+        explicit File(const std::string& path)
+        {
+            const int fd { ::open(path.c_str(), O_RDONLY) };
+            if (fd < 0)
+                return;
+            struct stat info {};
+            if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(Header))
+            {
+                m_size = static_cast<std::size_t>(info.st_size);
+                void* mapping { ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+                if (mapping != MAP_FAILED)
+                    m_data = static_cast<const std::uint8_t*>(mapping);
+            }
+            ::close(fd);
+            if (m_data)
+                std::memcpy(&m_header, m_data, sizeof(m_header));
+        }
+        ~File()
+        {
+            if (m_data)
+                ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        // True when the index is complete and was built from the history file with this fingerprint:
+        bool matches(const Fingerprint& history) const
+        {
+            return m_data && m_header.magic == Header{}.magic && m_header.version == Header{}.version
+                && m_header.historyBytes == history.bytes && m_header.historyRecords == history.records
+                && m_header.historyHash == history.hash && m_header.blocks <= m_size / sizeof(Block)
+                && m_header.tableOffset + m_header.blocks * sizeof(Block) == m_size;
+        }
+        const Header& header() const { return m_header; }
+        const Block& block(std::size_t index) const { return reinterpret_cast<const Block*>(m_data + m_header.tableOffset)[index]; }
+        const Word* bitmaps(const Block& block) const { return reinterpret_cast<const Word*>(m_data + block.offset); }
+        // The block's configuration numbers, sorted; the Nth one's bitmap is the Nth after the result bitmaps.
+        const std::uint16_t* configs(const Block& block) const
+        {
+            const std::size_t bitmapCount { 1u + static_cast<std::size_t>(__builtin_popcount(block.upcards) + __builtin_popcount(block.totals)
+                                                                         + __builtin_popcount(block.results)) + block.configs };
+            return reinterpret_cast<const std::uint16_t*>(bitmaps(block) + bitmapCount * m_header.blockRecords / 64);
+        }
+    };
+}
+
+// The bitmap loops, in a plain version and an AVX2 version picked once at startup.
+namespace Bits
+{
+    using Index::Word;
+
+    void andScalar(Word* into, const Word* bitmap, int words)
+    {
+        for (int i {0}; i < words; ++i)
+            into[i] &= bitmap[i];
+    }
+    void andNotScalar(Word* into, const Word* bitmap, int words)
+    {
+        for (int i {0}; i < words; ++i)
+            into[i] &= ~bitmap[i];
+    }
+    std::uint64_t countAndScalar(const Word* a, const Word* b, int words)
+    {
+        std::uint64_t count {0};
+        for (int i {0}; i < words; ++i)
+            count += static_cast<std::uint64_t>(__builtin_popcountll(a[i] & b[i]));
+        return count;
+    }
+
+    __attribute__((target("avx2"))) void andAvx2(Word* into, const Word* bitmap, int words)
+    {
+        int i {0};
+        for (; i + 4 <= words; i += 4)
+        {
+            const __m256i a { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(into + i)) };
+            const __m256i b { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bitmap + i)) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(into + i), _mm256_and_si256(a, b));
+        }
+        andScalar(into + i, bitmap + i, words - i);
+    }
+    __attribute__((target("avx2"))) void andNotAvx2(Word* into, const Word* bitmap, int words)
+    {
+        int i {0};
+        for (; i + 4 <= words; i += 4)
+        {
+            const __m256i a { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(into + i)) };
+            const __m256i b { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bitmap + i)) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(into + i), _mm256_andnot_si256(b, a));
+        }
+        andNotScalar(into + i, bitmap + i, words - i);
+    }
+    // Popcount of a & b: each byte is counted by looking its two nibbles up in a 16-entry table (vpshufb),
+    // and the byte counts are summed into 64-bit lanes (vpsadbw).
+    __attribute__((target("avx2"))) std::uint64_t countAndAvx2(const Word* a, const Word* b, int words)
+    {
+        const __m256i table { _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4) };
+        const __m256i lowNibble { _mm256_set1_epi8(0x0f) };
+        __m256i sums { _mm256_setzero_si256() };
+        int i {0};
+        for (; i + 4 <= words; i += 4)
+        {
+            const __m256i both { _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))) };
+            const __m256i low { _mm256_shuffle_epi8(table, _mm256_and_si256(both, lowNibble)) };
+            const __m256i high { _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(both, 4), lowNibble)) };
+            sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+        }
+        alignas(32) std::array<std::uint64_t,4> lanes {};
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.data()), sums);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + countAndScalar(a + i, b + i, words - i);
+    }
+
+    struct Kernels
+    {
+        void (*andInto)(Word*, const Word*, int);
+        void (*andNotInto)(Word*, const Word*, int);
+        std::uint64_t (*countAnd)(const Word*, const Word*, int);
+        const char* name;
+    };
+    Kernels pick()
+    {
+        if (__builtin_cpu_supports("avx2"))
+            return { andAvx2, andNotAvx2, countAndAvx2, "AVX2" };
+        return { andScalar, andNotScalar, countAndScalar, "scalar" };
+    }
+}
+
+struct Query
+{
+    int upcard {0};   // 2-11, or 0 for any
+    int total {-1};   // starting total, or -1 for any
+    int soft {-1};    // 1 soft, 0 hard, -1 either
+    int config {-1};  // sweep configuration, or -1 for all of them
+};
+
+// Counts the matching hands under each result, block by block in parallel.
+std::array<std::uint64_t,History::maxRecordResult> runQuery(const Index::File& index, const Query& query, TaskPool& pool,
+                                                            std::uint64_t& blocksScanned)
+{
+    using Index::Word;
+    const Bits::Kernels kernels { Bits::pick() };
+    const int words { static_cast<int>(index.header().blockRecords / 64) };
+    const std::size_t blocks { index.header().blocks };
+    std::vector<std::array<std::uint64_t,History::maxRecordResult>> perBlock( blocks );
+    std::vector<std::uint8_t> scanned( blocks );
+
+    pool.run(blocks, [&](std::size_t blockIndex, int) {
+        const Index::Block& block { index.block(blockIndex) };
+        const int upBit { query.upcard - 2 };
+        // Zone check: a block without the wanted upcard, total or configuration can't match anything.
+        if ((query.upcard && !(block.upcards >> upBit & 1)) || (query.total >= 0 && !(block.totals >> query.total & 1)))
+            return;
+        const std::uint16_t* configs { index.configs(block) };
+        const std::uint16_t* config { std::lower_bound(configs, configs + block.configs, query.config) };
+        if (query.config >= 0 && (config == configs + block.configs || *config != query.config))
+            return;
+        scanned[blockIndex] = 1;
+
+        // Bitmaps are laid out soft, upcards, totals, results; absent values have no bitmap.
+        const Word* soft { index.bitmaps(block) };
+        auto nth { [&](std::uint32_t present, int value, int before) {
+            const int rank { __builtin_popcount(present & ((1u << value) - 1)) };
+            return soft + static_cast<std::size_t>(1 + before + rank) * static_cast<std::size_t>(words);
+        } };
+        const int upcardCount { __builtin_popcount(block.upcards) };
+        const int totalCount { __builtin_popcount(block.totals) };
+        const int resultCount { __builtin_popcount(block.results) };
+
+        // Start from "every record in the block" and narrow it down:
+        std::vector<Word> match( static_cast<std::size_t>(words), ~Word{0} );
+        const std::uint32_t tail { block.records % 64 };
+        if (block.records < index.header().blockRecords)
+        {
+            std::fill(match.begin() + block.records / 64, match.end(), 0);
+            if (tail)
+                match[block.records / 64] = (Word{1} << tail) - 1;
+        }
+        if (query.upcard)
+            kernels.andInto(match.data(), nth(block.upcards, upBit, 0), words);
+        if (query.total >= 0)
+            kernels.andInto(match.data(), nth(block.totals, query.total, upcardCount), words);
+        if (query.soft == 1)
+            kernels.andInto(match.data(), soft, words);
+        else if (query.soft == 0)
+            kernels.andNotInto(match.data(), soft, words);
+        if (query.config >= 0)
+            kernels.andInto(match.data(), soft + static_cast<std::size_t>(1 + upcardCount + totalCount + resultCount + (config - configs))
+                                                 * static_cast<std::size_t>(words), words);
+
+        for (int result {0}; result < History::maxRecordResult; ++result)
+        {
+            if (block.results >> result & 1)
+                perBlock[blockIndex][result] = kernels.countAnd(match.data(), nth(block.results, result, upcardCount + totalCount), words);
+        }
+    });
+
+    std::array<std::uint64_t,History::maxRecordResult> counts {};
+    blocksScanned = 0;
+    for (std::size_t block {0}; block < blocks; ++block)
+    {
+        blocksScanned += scanned[block];
+        for (int result {0}; result < History::maxRecordResult; ++result)
+            counts[result] += perBlock[block][result];
+    }
+    return counts;
+}
+
+int usage()
+{
+    std::cerr << "Usage: query index FILE\n"
+              << "       query FILE [--config N] [--up 2-9|T|A] [--total N] [--soft | --hard] [--threads N]\n";
+    return 1;
+}
+int parseUpcard(std::string_view text)
+{
+    if (text == "A" || text == "a" || text == "11")
+        return 11;
+    if (text == "T" || text == "J" || text == "Q" || text == "K" || text == "10")
+        return 10;
+    if (text.size() == 1 && text[0] >= '2' && text[0] <= '9')
+        return text[0] - '0';
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return usage();
+    int threads { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+
+    if (std::string_view{argv[1]} == "index")
+    {
+        if (argc < 3)
+            return usage();
+        TaskPool pool { threads };
+        if (!Index::build(argv[2], pool))
+        {
+            std::cerr << "Could not index " << argv[2] << ".\n";
+            return 1;
+        }
+        std::cout << "Wrote " << Index::pathFor(argv[2]) << '\n';
+        return 0;
+    }
+
+    const std::string historyPath { argv[1] };
+    Query query {};
+    try
+    {
+        for (int arg {2}; arg < argc; ++arg)
+        {
+            const std::string_view name { argv[arg] };
+            if (name == "--soft")
+                query.soft = 1;
+            else if (name == "--hard")
+                query.soft = 0;
+            else if (arg + 1 < argc && name == "--up")
+                query.upcard = parseUpcard(argv[++arg]);
+            else if (arg + 1 < argc && name == "--total")
+            {
+                query.total = std::stoi(argv[++arg]);
+                if (query.total < 0) // -1 is "any" inside, but not something to ask for
+                    return usage();
+            }
+            else if (arg + 1 < argc && name == "--config")
+            {
+                query.config = std::stoi(argv[++arg]);
+                if (query.config < 0 || query.config > 0xFFFF)
+                    return usage();
+            }
+            else if (arg + 1 < argc && name == "--threads")
+                threads = std::stoi(argv[++arg]);
+            else
+                return usage();
+        }
+    }
+    catch (const std::exception&)
+    {
+        return usage();
+    }
+    if (query.upcard < 0 || query.total >= Index::totals || threads < 1)
+        return usage();
+
+    Index::Fingerprint history {};
+    {
+        const History::Reader reader { historyPath };
+        if (!reader.isOpen())
+        {
+            std::cerr << historyPath << " is not a hand history file.\n";
+            return 1;
+        }
+        history = Index::fingerprint(reader);
+    }
+    TaskPool pool { threads };
+    // Build (or rebuild) the index the first time a history file is queried:
+    if (!Index::File{ Index::pathFor(historyPath) }.matches(history))
+    {
+        std::cout << "Indexing " << historyPath << "...\n";
+        if (!Index::build(historyPath, pool))
+        {
+            std::cerr << "Could not index " << historyPath << ".\n";
+            return 1;
+        }
+    }
+    const Index::File index { Index::pathFor(historyPath) };
+    if (!index.matches(history))
+    {
+        std::cerr << Index::pathFor(historyPath) << " is not a usable index.\n";
+        return 1;
+    }
+
+    std::uint64_t blocksScanned {0};
+    const auto counts { runQuery(index, query, pool, blocksScanned) };
+    const std::uint64_t hands { counts[History::recordWin] + counts[History::recordTie] + counts[History::recordLose] };
+
+    if (query.config >= 0)
+        std::cout << "Configuration " << query.config << '\n';
+    else if (index.header().configs > 1)
+        std::cout << "All " << index.header().configs << " configurations pooled (pick one with --config N)\n";
+    std::cout << "Dealer shows " << (query.upcard ? (query.upcard == 11 ? "A" : query.upcard == 10 ? "T" : std::to_string(query.upcard)) : "any")
+              << ", player starts on " << (query.soft == 1 ? "soft " : query.soft == 0 ? "hard " : "")
+              << (query.total >= 0 ? std::to_string(query.total) : "any total") << '\n';
+    std::cout << hands << " hands (" << blocksScanned << " of " << index.header().blocks << " blocks scanned, "
+              << Bits::pick().name << ")\n";
+    if (hands > 0)
+    {
+        auto percent { [&](std::uint64_t count) { return 100.0 * static_cast<double>(count) / static_cast<double>(hands); } };
+        std::cout << std::fixed << std::setprecision(2)
+                  << counts[History::recordWin] << " wins (" << percent(counts[History::recordWin]) << "%), "
+                  << counts[History::recordTie] << " ties (" << percent(counts[History::recordTie]) << "%), "
+                  << counts[History::recordLose] << " losses (" << percent(counts[History::recordLose]) << "%)\n";
+    }
+    return 0;
+}
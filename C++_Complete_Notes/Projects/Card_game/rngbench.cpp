@@ -0,0 +1,170 @@
+#include <string_view>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include "Card.h"
+#include "Deck.h"
+#include "Random.h"
+#include "MultiStream.h"
+
+// Throughput of every engine Random.h can be built on, for the work the games give it:
+//
+//   rngbench [millions]      raw numbers, bounded integers and shuffling a 52-card Deck
+//
+// Bounded integers and shuffles are timed both through std::uniform_int_distribution / std::shuffle and through
+// Random::get / Random::shuffle, which draw with Lemire's multiply-shift method instead. get<1,52> and get<0,63>
+// are the same draws with the bounds fixed at compile time; 0..63 is a power of two and never rejects. The last
+// column is the rate Random::fill produces 32-bit values in 1..52 at, into a buffer that stays in cache.
+//
+// Each engine is driven directly, so one binary compares them all whichever Random::Engine it was built with.
+// The 16-stream xoshiro256** is timed with the step the CPU picked, after checking it against the plain step.
+// Random::get<Min, Max> is checked first too, on bounds that don't fit a 32-bit engine's word.
+
+// Nanoseconds per call of `step`, run `calls` times; `sink` keeps the work from being optimised away.
+template <typename Step>
+double timePerCall(std::uint64_t calls, std::uint64_t& sink, Step step)
+{
+    std::uint64_t sum {0}; // a local, so the loop doesn't store to `sink` on every call
+    const auto start { std::chrono::steady_clock::now() };
+    for (std::uint64_t i {0}; i < calls; ++i)
+        sum += step();
+    const std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+    sink += sum;
+    return elapsed.count() / static_cast<double>(calls);
+}
+
+template <typename Engine>
+void benchEngine(std::string_view name, std::uint64_t calls, std::uint64_t& sink)
+{
+    std::seed_seq ss { 1u, 2u, 3u };
+    Engine engine { ss };
+    std::array<Card,52> cards { canonicalDeck<Card,52> };
+
+    const double raw { timePerCall(calls, sink, [&] { return static_cast<std::uint64_t>(engine()); }) };
+    const double dist52 { timePerCall(calls, sink, [&] {
+        return static_cast<std::uint64_t>(std::uniform_int_distribution{1, 52}(engine));
+    }) };
+    const double get52 { timePerCall(calls, sink, [&] { return static_cast<std::uint64_t>(Random::get(engine, 1, 52)); }) };
+    const double gold { timePerCall(calls, sink, [&] { return static_cast<std::uint64_t>(Random::get(engine, 80, 120)); }) };
+    const double fixed52 { timePerCall(calls, sink, [&] { return static_cast<std::uint64_t>(Random::get<1, 52>(engine)); }) };
+    const double fixed64 { timePerCall(calls, sink, [&] { return static_cast<std::uint64_t>(Random::get<0, 63>(engine)); }) };
+    const double stdShuffle { timePerCall(calls / 52, sink, [&] {
+        std::shuffle(cards.begin(), cards.end(), engine);
+        return static_cast<std::uint64_t>(cards[0].index());
+    }) };
+    const double shuffle { timePerCall(calls / 52, sink, [&] {
+        Random::shuffle(cards.begin(), cards.end(), engine);
+        return static_cast<std::uint64_t>(cards[0].index());
+    }) };
+
+    std::vector<int> buffer( 1 << 14 );
+    const std::uint64_t fills { std::max<std::uint64_t>(1, calls / buffer.size()) };
+    const double fill { timePerCall(fills, sink, [&] {
+        Random::fill(engine, buffer.data(), buffer.size(), 1, 52);
+        return static_cast<std::uint64_t>(buffer[0]);
+    }) / static_cast<double>(buffer.size()) };
+
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(2)
+              << std::setw(8) << raw << std::setw(12) << dist52 << std::setw(11) << get52 << std::setw(13) << gold
+              << std::setw(11) << fixed52 << std::setw(11) << fixed64 << std::setw(14) << stdShuffle << std::setw(17) << shuffle << std::setw(13) << sizeof(int) / fill << '\n';
+}
+
+// Every vector step the CPU has must give the same numbers as the plain one:
+bool checkMultiStream()
+{
+    std::seed_seq ss { 4u, 5u, 6u };
+    MultiStream::Xoshiro256x16 seeded { ss };
+    MultiStream::State start {};
+    for (int lane {0}; lane < MultiStream::lanes; ++lane)
+        start[0][lane] = seeded(); // any state will do
+
+    constexpr std::size_t blocks {1000};
+    std::vector<std::uint64_t> expected( blocks * MultiStream::lanes );
+    MultiStream::State state { start };
+    MultiStream::stepScalar(state, expected.data(), blocks);
+
+    auto matches { [&](void (*step)(MultiStream::State&, std::uint64_t*, std::size_t), const char* name) {
+        std::vector<std::uint64_t> got( blocks * MultiStream::lanes );
+        MultiStream::State copy { start };
+        step(copy, got.data(), blocks);
+        if (got != expected || copy != state)
+        {
+            std::cout << "The " << name << " step does not match the plain one.\n";
+            return false;
+        }
+        return true;
+    } };
+    bool ok { true };
+    if (__builtin_cpu_supports("avx2"))
+        ok = matches(MultiStream::stepAvx2, "AVX2") && ok;
+    if (__builtin_cpu_supports("avx512f"))
+        ok = matches(MultiStream::stepAvx512, "AVX-512") && ok;
+    return ok;
+}
+
+// Every draw of get<Min, Max> must land in [Min, Max], and a narrow range must reach both ends:
+template <auto Min, auto Max, typename Engine>
+bool checkBounds(Engine& engine, std::string_view name)
+{
+    bool low { false };
+    bool high { false };
+    for (int i {0}; i < 100000; ++i)
+    {
+        const auto value { Random::get<Min, Max>(engine) };
+        if (value < Min || value > Max)
+        {
+            std::cout << "Random::get<" << Min << ", " << Max << "> on " << name << " gave " << value << ".\n";
+            return false;
+        }
+        low = low || value == Min;
+        high = high || value == Max;
+    }
+    if (Max - Min < 1000 && !(low && high))
+    {
+        std::cout << "Random::get<" << Min << ", " << Max << "> on " << name << " never drew one of its bounds.\n";
+        return false;
+    }
+    return true;
+}
+template <typename Engine>
+bool checkGetBounds(Engine& engine, std::string_view name)
+{
+    bool ok { true };
+    ok = checkBounds<-10LL, 10LL>(engine, name) && ok;
+    ok = checkBounds<-8, 7>(engine, name) && ok;                              // a power of two
+    ok = checkBounds<5000000000LL, 5000000010LL>(engine, name) && ok;          // above 2^32
+    ok = checkBounds<-5000000010LL, -5000000000LL>(engine, name) && ok;
+    ok = checkBounds<5LL, 5LL + 0xFFFFFFFFLL>(engine, name) && ok;             // exactly 2^32 values
+    ok = checkBounds<std::int16_t{-300}, std::int16_t{-200}>(engine, name) && ok;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    std::mt19937 mt32 { 7u };
+    std::mt19937_64 mt64 { 7u };
+    if (!checkMultiStream() || !checkGetBounds(mt32, "mt19937") || !checkGetBounds(mt64, "mt19937_64")
+        || !checkGetBounds(Random::mt, "Random::mt"))
+        return 1;
+
+    const std::uint64_t millions { argc > 1 ? std::stoull(argv[1]) : 20 };
+    const std::uint64_t calls { millions * 1000000 };
+    std::uint64_t sink {0};
+
+    std::cout << calls << " calls per column, times in ns per call\n\n"
+              << "      engine     raw  dist(1,52)  get(1,52)  get(80,120)  get<1,52>  get<0,63>  std::shuffle  Random::shuffle  fill GB/s\n";
+    benchEngine<std::mt19937>("mt19937", calls, sink);
+    benchEngine<std::mt19937_64>("mt19937_64", calls, sink);
+    benchEngine<Random::Xoshiro256StarStar>("xoshiro256**", calls, sink);
+    benchEngine<Random::Pcg64>("pcg64", calls, sink);
+    benchEngine<Random::Wyrand>("wyrand", calls, sink);
+    benchEngine<MultiStream::Xoshiro256x16>("xoshiro x16", calls, sink);
+    std::cout << "\n(xoshiro x16 steps 16 streams at once with the " << MultiStream::kernel().name << " step)";
+    std::cout << "\n(checksum " << sink % 1000 << ")\n";
+    return 0;
+}
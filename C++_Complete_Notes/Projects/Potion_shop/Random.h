@@ -1,39 +1,614 @@
 #ifndef RANDOM_MT_H
 #define RANDOM_MT_H
 
-#include <chrono>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <random>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+#if __has_include(<sys/random.h>)
+#include <sys/random.h> // getrandom
+#endif
 
 // This header-only Random namespace implements a self-seeding Mersenne Twister.
+// (Or a faster small-state engine, picked at compile time: see Random::Engine below.)
 // Requires C++17 or newer.
 // It can be #included into as many code files as needed (The inline keyword avoids ODR violations)
 // Freely redistributable, courtesy of learncpp.com (https://www.learncpp.com/cpp-tutorial/global-random-numbers-random-h/)
 namespace Random
 {
-	// Returns a seeded Mersenne Twister
-	// Note: we'd prefer to return a std::seed_seq (to initialize a std::mt19937), but std::seed can't be copied, so it can't be returned by value.
-	// Instead, we'll create a std::mt19937, seed it, and then return the std::mt19937 (which can be copied).
-	inline std::mt19937 generate()
+	// Small-state engines that can stand in for std::mt19937 (2.5 KB of state) where drawing numbers is hot.
+	// All three produce 64-bit numbers and are seeded from a std::seed_seq, like std::mt19937.
+
+	// Fills `words` 64-bit seed words from a std::seed_seq:
+	template <std::size_t words>
+	std::array<std::uint64_t, words> seedWords(std::seed_seq& ss)
+	{
+		std::array<std::uint32_t, words * 2> halves{};
+		ss.generate(halves.begin(), halves.end());
+		std::array<std::uint64_t, words> seed{};
+		for (std::size_t i{ 0 }; i < words; ++i)
+			seed[i] = (static_cast<std::uint64_t>(halves[i * 2]) << 32) | halves[i * 2 + 1];
+		return seed;
+	}
+
+	// xoshiro256** (Blackman and Vigna): 32 bytes of state, a few shifts and rotates per number.
+	class Xoshiro256StarStar
+	{
+	private:
+		std::array<std::uint64_t, 4> m_state{};
+
+		static constexpr std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		// Moves the state on by the power of two whose jump polynomial is `polynomial` (from the reference code):
+		void jumpBy(const std::array<std::uint64_t, 4>& polynomial)
+		{
+			std::array<std::uint64_t, 4> jumped{};
+			for (std::uint64_t word : polynomial)
+			{
+				for (int bit{ 0 }; bit < 64; ++bit)
+				{
+					if (word & (std::uint64_t{ 1 } << bit))
+					{
+						for (int i{ 0 }; i < 4; ++i)
+							jumped[i] ^= m_state[i];
+					}
+					(*this)();
+				}
+			}
+			m_state = jumped;
+		}
+
+	public:
+		using result_type = std::uint64_t;
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~result_type{ 0 }; }
+
+		Xoshiro256StarStar() { std::seed_seq ss{}; seed(ss); }
+		explicit Xoshiro256StarStar(std::seed_seq& ss) { seed(ss); }
+		explicit Xoshiro256StarStar(const std::array<std::uint64_t, 4>& state) : m_state{ state } {}
+		void seed(std::seed_seq& ss)
+		{
+			m_state = seedWords<4>(ss);
+			if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0)
+				m_state[0] = 1; // the all-zero state never leaves zero
+		}
+		const std::array<std::uint64_t, 4>& state() const { return m_state; }
+
+		// The same as 2^128 calls: the period (2^256 - 1) splits into 2^128 streams that can't overlap.
+		void jump() { jumpBy({ 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c }); }
+		// The same as 2^192 calls, for handing out groups of jump()-separated streams.
+		void longJump() { jumpBy({ 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 }); }
+
+		// A child generator that takes the next 2^128 numbers, while this one jumps past them:
+		Xoshiro256StarStar split()
+		{
+			Xoshiro256StarStar child{ *this };
+			jump();
+			return child;
+		}
+
+		result_type operator()()
+		{
+			const std::uint64_t result{ rotl(m_state[1] * 5, 7) * 9 };
+			const std::uint64_t t{ m_state[1] << 17 };
+			m_state[2] ^= m_state[0];
+			m_state[3] ^= m_state[1];
+			m_state[1] ^= m_state[2];
+			m_state[0] ^= m_state[3];
+			m_state[2] ^= t;
+			m_state[3] = rotl(m_state[3], 45);
+			return result;
+		}
+	};
+
+	// PCG64 (O'Neill), the XSL RR 128/64 member: a 128-bit linear congruential step and a permuted 64-bit output.
+	class Pcg64
+	{
+	private:
+		unsigned __int128 m_state{};
+		unsigned __int128 m_increment{ 1 }; // must be odd
+
+		static constexpr unsigned __int128 multiplier{ (static_cast<unsigned __int128>(0x2360ED051FC65DA4) << 64) | 0x4385DF649FCCF645 };
+
+	public:
+		using result_type = std::uint64_t;
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~result_type{ 0 }; }
+
+		Pcg64() { std::seed_seq ss{}; seed(ss); }
+		explicit Pcg64(std::seed_seq& ss) { seed(ss); }
+		void seed(std::seed_seq& ss)
+		{
+			const auto words{ seedWords<4>(ss) };
+			m_increment = (((static_cast<unsigned __int128>(words[2]) << 64) | words[3]) << 1) | 1;
+			m_state = 0;
+			(*this)();
+			m_state += (static_cast<unsigned __int128>(words[0]) << 64) | words[1];
+			(*this)();
+		}
+
+		// The same as `steps` calls, in O(log steps) (Brown, "Random Number Generation with Arbitrary Strides", 1994):
+		void advance(unsigned __int128 steps)
+		{
+			unsigned __int128 totalMultiplier{ 1 };
+			unsigned __int128 totalIncrement{ 0 };
+			unsigned __int128 multiplierStep{ multiplier };
+			unsigned __int128 incrementStep{ m_increment };
+			for (; steps > 0; steps >>= 1)
+			{
+				if (steps & 1)
+				{
+					totalMultiplier *= multiplierStep;
+					totalIncrement = totalIncrement * multiplierStep + incrementStep;
+				}
+				incrementStep = (multiplierStep + 1) * incrementStep;
+				multiplierStep *= multiplierStep;
+			}
+			m_state = totalMultiplier * m_state + totalIncrement;
+		}
+		// A child generator that takes the next 2^96 numbers, while this one advances past them:
+		Pcg64 split()
+		{
+			Pcg64 child{ *this };
+			advance(static_cast<unsigned __int128>(1) << 96);
+			return child;
+		}
+
+		result_type operator()()
+		{
+			m_state = m_state * multiplier + m_increment;
+			const std::uint64_t folded{ static_cast<std::uint64_t>(m_state >> 64) ^ static_cast<std::uint64_t>(m_state) };
+			const int rotation{ static_cast<int>(m_state >> 122) };
+			return (folded >> rotation) | (folded << ((-rotation) & 63));
+		}
+	};
+
+	// wyrand (Wang Yi): one 64-bit counter and one 64x64->128 multiply per number; the smallest and usually the fastest.
+	class Wyrand
+	{
+	private:
+		std::uint64_t m_state{};
+
+	public:
+		using result_type = std::uint64_t;
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~result_type{ 0 }; }
+
+		Wyrand() { std::seed_seq ss{}; seed(ss); }
+		explicit Wyrand(std::seed_seq& ss) { seed(ss); }
+		void seed(std::seed_seq& ss) { m_state = seedWords<1>(ss)[0]; }
+
+		// The state is a counter, so advancing is one multiply:
+		void advance(std::uint64_t steps) { m_state += steps * 0xa0761d6478bd642f; }
+		// A child generator that takes the next 2^40 numbers, while this one advances past them:
+		Wyrand split()
+		{
+			Wyrand child{ *this };
+			advance(std::uint64_t{ 1 } << 40);
+			return child;
+		}
+
+		result_type operator()()
+		{
+			m_state += 0xa0761d6478bd642f;
+			const unsigned __int128 product{ static_cast<unsigned __int128>(m_state) * (m_state ^ 0xe7037ed1a0b428db) };
+			return static_cast<std::uint64_t>(product >> 64) ^ static_cast<std::uint64_t>(product);
+		}
+	};
+
+	// Engines that can hand out non-overlapping child generators with split():
+	template <typename URBG, typename = void>
+	inline constexpr bool splittable{ false };
+	template <typename URBG>
+	inline constexpr bool splittable<URBG, std::void_t<decltype(std::declval<URBG&>().split())>>{ true };
+
+	// A child generator for another worker. Engines with split() hand out a stream that can't overlap the parent's;
+	// any other engine (std::mt19937 included) is seeded from eight numbers of the parent's, which is reproducible
+	// but only statistically apart from the parent's stream.
+	template <typename URBG>
+	URBG split(URBG& parent)
+	{
+		if constexpr (splittable<URBG>)
+		{
+			return parent.split();
+		}
+		else
+		{
+			std::array<std::uint32_t, 8> words{};
+			for (auto& word : words)
+				word = static_cast<std::uint32_t>(parent());
+			std::seed_seq ss(words.begin(), words.end());
+			return URBG{ ss };
+		}
+	}
+
+	// The engine behind Random::mt, picked at compile time; std::mt19937 unless one of these is defined:
+	//   -DRANDOM_ENGINE_XOSHIRO256SS, -DRANDOM_ENGINE_PCG64 or -DRANDOM_ENGINE_WYRAND
+#if defined(RANDOM_ENGINE_XOSHIRO256SS)
+	using Engine = Xoshiro256StarStar;
+#elif defined(RANDOM_ENGINE_PCG64)
+	using Engine = Pcg64;
+#elif defined(RANDOM_ENGINE_WYRAND)
+	using Engine = Wyrand;
+#else
+	using Engine = std::mt19937;
+#endif
+
+	// Random words from the operating system, all in one getrandom() call where there is one, rather than
+	// a std::random_device draw (a system call on some hosts) per word:
+	template <std::size_t words>
+	std::array<std::uint32_t, words> entropy()
 	{
+		std::array<std::uint32_t, words> seed{};
+#if __has_include(<sys/random.h>)
+		if (::getrandom(seed.data(), sizeof(seed), 0) == static_cast<ssize_t>(sizeof(seed)))
+			return seed;
+#endif
 		std::random_device rd{};
+		for (auto& word : seed)
+			word = rd();
+		return seed;
+	}
 
-		// Create seed_seq with clock and 7 random numbers from std::random_device
-		std::seed_seq ss{
-			static_cast<std::seed_seq::result_type>(std::chrono::steady_clock::now().time_since_epoch().count()),
-				rd(), rd(), rd(), rd(), rd(), rd(), rd() };
+	// The program's seed: the number in the RANDOM_SEED environment variable when there is one, otherwise 64 bits
+	// from the operating system. Every generator the program seeds itself comes from it, so reporting this one number
+	// is enough to replay a run: RANDOM_SEED=<seed> ./main ...
+	// Anything else in RANDOM_SEED is a mistake the run can't recover from (it would silently not replay), so it stops there.
+	inline std::uint64_t startingSeed()
+	{
+		if (const char* text{ std::getenv("RANDOM_SEED") })
+		{
+			// strtoull() would take "-5" as 2^64 - 5 and skip leading spaces, so the number has to start with a digit:
+			char* end{};
+			errno = 0;
+			const std::uint64_t seed{ std::strtoull(text, &end, 0) };
+			if (*text >= '0' && *text <= '9' && *end == '\0' && errno == 0)
+				return seed;
+			std::fprintf(stderr, "RANDOM_SEED must be a whole number from 0 to 18446744073709551615, not \"%s\".\n", text);
+			std::exit(EXIT_FAILURE);
+		}
+		const auto words{ entropy<2>() };
+		return (static_cast<std::uint64_t>(words[0]) << 32) | words[1];
+	}
+	// Worked out on first use, like the generators (a function-local static, so a program that never draws never asks).
+	// When setSeed() is the first use, its seed is taken as it is and the operating system isn't asked at all:
+	inline std::atomic<std::uint64_t>& programSeed(const std::uint64_t* chosen = nullptr)
+	{
+		static std::atomic<std::uint64_t> seed{ chosen ? *chosen : startingSeed() };
+		return seed;
+	}
+	// How many threads have seeded their generator from the program's seed so far:
+	inline std::atomic<std::uint32_t> streamsSeeded{ 0 };
+
+	// The seed this run uses, to report so the run can be reproduced:
+	inline std::uint64_t seedUsed() { return programSeed().load(); }
+
+	// The generator for stream number `stream` of a run with the given seed:
+	inline Engine generate(std::uint64_t seed, std::uint32_t stream)
+	{
+		// Create seed_seq with the two halves of the seed and the stream number
+		std::seed_seq ss{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32), stream };
 
-		return std::mt19937{ ss };
+		return Engine{ ss };
+	}
+	// The generator for the next thread to need one. Threads are numbered in the order they first draw, the first
+	// one (usually the main thread) being 0, so a run replays exactly when its threads first draw in the same order,
+	// as any single-threaded run does.
+	inline Engine generate()
+	{
+		return generate(seedUsed(), streamsSeeded.fetch_add(1));
 	}
 
-	// Here's our global std::mt19937 object.
-	// The inline keyword means we only have one global instance for our whole program.
-	inline std::mt19937 mt{ generate() }; // generates a seeded std::mt19937 and copies it into our global object
+	// Seeds a thread's generator on its first use, noting that it has been, for setSeed():
+	inline thread_local bool mtSeeded{ false };
+	inline Engine firstUse()
+	{
+		mtSeeded = true;
+		return generate();
+	}
+
+	// Here's our global Engine object.
+	// The inline keyword means we only have one definition for our whole program.
+	// The thread_local keyword gives every thread its own instance, seeded independently the first time that thread uses it,
+	// so threads can draw numbers at the same time without a data race or a lock around the generator.
+	// Seeding waits for that first use (GCC and Clang run a thread_local's initializer lazily, the main thread included),
+	// so a run that never draws a number never pays for it: about 0.5 us of getrandom() plus about 25 us for std::mt19937
+	// to expand the seed into its 5 KB state, or well under 1 us for the small engines.
+	inline thread_local Engine mt{ firstUse() }; // generates a seeded Engine and copies it into this thread's object
+
+	// Makes `seed` the program's seed, as if the run had been started with RANDOM_SEED=seed: the calling thread's
+	// generator is stream 0, and threads that haven't drawn yet follow on from stream 1. A generator that has already
+	// been seeded starts over; one that hasn't is left to be seeded once, from the new seed, when it is first used.
+	inline void setSeed(std::uint64_t seed)
+	{
+		programSeed(&seed).store(seed);
+		if (mtSeeded)
+		{
+			streamsSeeded.store(1);
+			mt = generate(seed, 0);
+		}
+		else
+		{
+			streamsSeeded.store(0);
+		}
+	}
+
+	// Bounded integers by Lemire's multiply-shift method ("Fast Random Integer Generation in an Interval", 2019):
+	// a number in [0, range) is the high half of random bits times range. Only draws that land in the small
+	// biased sliver are redrawn, and the one division that finds that sliver is only done when a draw comes close,
+	// where many std::uniform_int_distribution implementations divide on every call.
+	template <typename URBG>
+	inline constexpr bool bits32{ URBG::min() == 0 && URBG::max() == 0xFFFFFFFFu };
+	template <typename URBG>
+	inline constexpr bool bits64{ URBG::min() == 0 && URBG::max() == ~std::uint64_t{ 0 } };
+
+	// Engines that can hand out a whole buffer of 64-bit numbers at once, with generateBits(out, count):
+	template <typename URBG, typename = void>
+	inline constexpr bool bulkBits{ false };
+	template <typename URBG>
+	inline constexpr bool bulkBits<URBG, std::void_t<decltype(std::declval<URBG&>().generateBits(std::declval<std::uint64_t*>(), std::size_t{}))>>{ true };
+
+	// 32 random bits (the high half of a 64-bit engine's output):
+	template <typename URBG>
+	inline std::uint32_t next32(URBG& engine)
+	{
+		if constexpr (bits32<URBG>)
+			return static_cast<std::uint32_t>(engine());
+		else
+			return static_cast<std::uint32_t>(engine() >> 32);
+	}
+	// 64 random bits (two draws of a 32-bit engine):
+	template <typename URBG>
+	inline std::uint64_t next64(URBG& engine)
+	{
+		if constexpr (bits64<URBG>)
+			return engine();
+		else
+			return (static_cast<std::uint64_t>(engine()) << 32) | static_cast<std::uint32_t>(engine());
+	}
+
+	// Uniform in [0, range), range > 0:
+	template <typename URBG>
+	inline std::uint32_t below(URBG& engine, std::uint32_t range)
+	{
+		std::uint64_t product{ static_cast<std::uint64_t>(next32(engine)) * range };
+		if (static_cast<std::uint32_t>(product) < range)
+		{
+			const std::uint32_t threshold{ -range % range }; // 2^32 mod range
+			while (static_cast<std::uint32_t>(product) < threshold)
+				product = static_cast<std::uint64_t>(next32(engine)) * range;
+		}
+		return static_cast<std::uint32_t>(product >> 32);
+	}
+	template <typename URBG>
+	inline std::uint64_t below(URBG& engine, std::uint64_t range)
+	{
+		unsigned __int128 product{ static_cast<unsigned __int128>(next64(engine)) * range };
+		if (static_cast<std::uint64_t>(product) < range)
+		{
+			const std::uint64_t threshold{ -range % range }; // 2^64 mod range
+			while (static_cast<std::uint64_t>(product) < threshold)
+				product = static_cast<unsigned __int128>(next64(engine)) * range;
+		}
+		return static_cast<std::uint64_t>(product >> 64);
+	}
+
+	// Two numbers from one draw, in [0, range) and [0, range - 1), for range * (range - 1) that fits in a Word.
+	// The low half of the first product is multiplied again for the second (Brackett-Rozinsky and Lemire,
+	// "Batched Ranged Random Integer Generation", 2024), so shuffling needs one draw for every two cards.
+	template <typename Word, typename Wide, typename URBG>
+	inline std::pair<Word, Word> belowPair(URBG& engine, Word range)
+	{
+		constexpr int bits{ sizeof(Word) * 8 };
+		const Word bound{ static_cast<Word>(range * (range - 1)) };
+		while (true)
+		{
+			Wide product{ static_cast<Wide>(bits == 32 ? next32(engine) : next64(engine)) * range };
+			const Word first{ static_cast<Word>(product >> bits) };
+			product = static_cast<Wide>(static_cast<Word>(product)) * (range - 1);
+			const Word second{ static_cast<Word>(product >> bits) };
+			const Word low{ static_cast<Word>(product) };
+			if (low >= bound || low >= static_cast<Word>(-bound % bound))
+				return { first, second };
+		}
+	}
+
+	// Generate a random value between [min, max] (inclusive) from the given engine rather than mt
+	// * any integer type; engines with neither 32 nor 64 full bits fall back to std::uniform_int_distribution
+	template <typename URBG, typename T>
+	inline T get(URBG& engine, T min, T max)
+	{
+		static_assert(std::is_integral_v<T>, "Random::get needs an integer type");
+		if constexpr (!bits32<URBG> && !bits64<URBG>)
+		{
+			return std::uniform_int_distribution<T>{min, max}(engine);
+		}
+		else if constexpr (sizeof(T) <= sizeof(std::uint32_t) && bits32<URBG>)
+		{
+			// The span is worked out in unsigned arithmetic, so it can't overflow for any min <= max:
+			const std::uint32_t span{ static_cast<std::uint32_t>(static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min)) };
+			if (span == 0xFFFFFFFFu)
+				return static_cast<T>(next32(engine));
+			return static_cast<T>(static_cast<std::uint32_t>(min) + below(engine, span + 1));
+		}
+		else
+		{
+			const std::uint64_t span{ static_cast<std::uint64_t>(max) - static_cast<std::uint64_t>(min) };
+			if (span == ~std::uint64_t{ 0 })
+				return static_cast<T>(next64(engine));
+			return static_cast<T>(static_cast<std::uint64_t>(min) + below(engine, span + 1));
+		}
+	}
+
+	// Shuffles [first, last) like std::shuffle (Fisher-Yates), drawing the indices two at a time with belowPair():
+	template <typename RandomIt, typename URBG>
+	void shuffle(RandomIt first, RandomIt last, URBG& engine)
+	{
+		using std::swap;
+		auto i{ static_cast<std::uint64_t>(std::distance(first, last)) };
+		if constexpr (bits32<URBG> || bits64<URBG>)
+		{
+			// Pairs while i * (i - 1) fits in one draw:
+			using Word = std::conditional_t<bits64<URBG>, std::uint64_t, std::uint32_t>;
+			using Wide = std::conditional_t<bits64<URBG>, unsigned __int128, std::uint64_t>;
+			constexpr std::uint64_t pairLimit{ bits64<URBG> ? std::uint64_t{ 1 } << 32 : std::uint64_t{ 1 } << 16 };
+			for (; i > 2; i -= 2)
+			{
+				if (i > pairLimit)
+				{
+					swap(first[i - 1], first[get(engine, std::uint64_t{ 0 }, i - 1)]);
+					++i; // one card placed, not two
+					continue;
+				}
+				const auto [one, other] { belowPair<Word, Wide>(engine, static_cast<Word>(i)) };
+				swap(first[i - 1], first[one]);
+				swap(first[i - 2], first[other]);
+			}
+			if (i == 2)
+				swap(first[1], first[below(engine, std::uint32_t{ 2 })]);
+		}
+		else
+		{
+			for (; i > 1; --i)
+				swap(first[i - 1], first[get(engine, std::uint64_t{ 0 }, i - 1)]);
+		}
+	}
+	template <typename RandomIt>
+	void shuffle(RandomIt first, RandomIt last)
+	{
+		shuffle(first, last, mt);
+	}
+
+	// Fills values[0, count) with random values between [min, max]: inclusive for integers, [min, max) for floating point.
+	// Cheaper per value than calling get() in a loop: the rejection threshold is worked out once per call, a 64-bit
+	// engine's output is split into two 32-bit values, and the numbers are drawn a block at a time into the output
+	// and then mapped onto the range in a second, branch-free loop the compiler can vectorize.
+	template <typename URBG, typename T>
+	void fill(URBG& engine, T* values, std::size_t count, T min, T max)
+	{
+		if constexpr (std::is_floating_point_v<T> && !bits32<URBG> && !bits64<URBG>)
+		{
+			std::uniform_real_distribution<T> distribution{ min, max };
+			for (std::size_t i{ 0 }; i < count; ++i)
+				values[i] = distribution(engine);
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			const T width{ max - min };
+			for (std::size_t i{ 0 }; i < count; ++i)
+			{
+				if constexpr (sizeof(T) <= sizeof(float))
+					values[i] = min + width * static_cast<T>(static_cast<float>(next32(engine) >> 8) * 0x1.0p-24f);
+				else
+					values[i] = min + width * static_cast<T>(static_cast<double>(next64(engine) >> 11) * 0x1.0p-53);
+			}
+		}
+		else if constexpr (sizeof(T) == sizeof(std::uint32_t) && (bits32<URBG> || bits64<URBG>))
+		{
+			const std::uint32_t span{ static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min) };
+			const std::uint32_t range{ span + 1 };
+			const std::uint32_t threshold{ range == 0 ? 0 : -range % range };
+			auto* bits{ reinterpret_cast<std::uint32_t*>(values) };
+
+			constexpr std::size_t block{ 256 };
+			for (std::size_t start{ 0 }; start < count; start += block)
+			{
+				const std::size_t size{ std::min(block, count - start) };
+				std::uint32_t* out{ bits + start };
+
+				// Raw bits first, two values per draw from a 64-bit engine:
+				std::array<std::uint32_t, block> raw; // not zeroed, every value gets written
+				std::size_t i{ 0 };
+				if constexpr (bits64<URBG> && bulkBits<URBG>)
+				{
+					std::array<std::uint64_t, block / 2> words;
+					engine.generateBits(words.data(), size / 2);
+					std::memcpy(raw.data(), words.data(), size / 2 * sizeof(std::uint64_t));
+					i = size / 2 * 2;
+				}
+				else if constexpr (bits64<URBG>)
+				{
+					for (; i + 2 <= size; i += 2)
+					{
+						const std::uint64_t word{ engine() };
+						raw[i] = static_cast<std::uint32_t>(word);
+						raw[i + 1] = static_cast<std::uint32_t>(word >> 32);
+					}
+				}
+				for (; i < size; ++i)
+					raw[i] = next32(engine);
+				for (; i < block; ++i)
+					raw[i] = ~std::uint32_t{ 0 }; // padding for a short last block, see below
+				if (range == 0)
+				{
+					std::memcpy(out, raw.data(), size * sizeof(std::uint32_t)); // the whole 32-bit range: the bits are the values
+					continue;
+				}
+
+				// Then onto the range, noting whether any value came from the biased sliver. The loop always runs over
+				// a whole block (a fixed trip count is what lets the compiler vectorize it at -O2); a short last block
+				// maps a few unused all-ones padding values. Those are never biased: 0xFFFFFFFF * range leaves
+				// 2^32 - range in the low half, and the threshold, (2^32 - range) % range, is never more than that.
+				std::array<std::uint32_t, block> mapped;
+				std::uint32_t biased{ 0 };
+				for (i = 0; i < block; ++i)
+				{
+					const std::uint64_t product{ static_cast<std::uint64_t>(raw[i]) * range };
+					biased |= static_cast<std::uint32_t>(static_cast<std::uint32_t>(product) < threshold);
+					mapped[i] = static_cast<std::uint32_t>(min) + static_cast<std::uint32_t>(product >> 32);
+				}
+				std::memcpy(out, mapped.data(), size * sizeof(std::uint32_t));
+				// Rare: those values are drawn again, one at a time (each value is independent of the others):
+				if (biased)
+				{
+					for (i = 0; i < size; ++i)
+					{
+						if (static_cast<std::uint32_t>(static_cast<std::uint64_t>(raw[i]) * range) < threshold)
+							out[i] = static_cast<std::uint32_t>(min) + below(engine, range);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (std::size_t i{ 0 }; i < count; ++i)
+				values[i] = get(engine, min, max);
+		}
+	}
+	template <typename T>
+	void fill(T* values, std::size_t count, T min, T max)
+	{
+		fill(mt, values, count, min, max);
+	}
+#if __cplusplus >= 202002L
+	template <typename URBG, typename T>
+	void fill(URBG& engine, std::type_identity_t<std::span<T>> values, T min, T max)
+	{
+		fill(engine, values.data(), values.size(), min, max);
+	}
+	template <typename T>
+	void fill(std::type_identity_t<std::span<T>> values, T min, T max)
+	{
+		fill(mt, values.data(), values.size(), min, max);
+	}
+#endif
 
 	// Generate a random int between [min, max] (inclusive)
         // * also handles cases where the two arguments have different types but can be converted to int
 	inline int get(int min, int max)
 	{
-		return std::uniform_int_distribution{min, max}(mt);
+		return get(mt, min, max);
 	}
 
 	// The following function templates can be used to generate random numbers in other cases
@@ -52,7 +627,7 @@ namespace Random
 	template <typename T>
 	T get(T min, T max)
 	{
-		return std::uniform_int_distribution<T>{min, max}(mt);
+		return get(mt, min, max);
 	}
 
 	// Generate a random value between [min, max] (inclusive)
@@ -67,6 +642,74 @@ namespace Random
 	// {
 	// 	return get<R>(static_cast<R>(min), static_cast<R>(max));
 	// }
+
+	// Generate a random value between [Min, Max] (inclusive), with the bounds fixed at compile time
+	// * Min and Max must have the same integer type, which is also the return type
+	// * the range and the rejection threshold are constants, so a draw is one multiply and one compare;
+	//   a range that is a power of two (like 0..63) is just the top bits of one draw, with nothing to reject
+	// Sample call: Random::get<1, 52>();           // returns int
+	// Sample call: Random::get<0u, 63u>(engine);   // returns unsigned int, drawn from engine rather than mt
+	template <auto Min, auto Max, typename URBG>
+	inline decltype(Min) get(URBG& engine)
+	{
+		using T = decltype(Min);
+		static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool> && std::is_same_v<T, decltype(Max)>,
+			"Random::get<Min, Max> needs two bounds of one integer type");
+		static_assert(Min <= Max, "Random::get<Min, Max> needs Min <= Max");
+
+		if constexpr (!bits32<URBG> && !bits64<URBG>)
+		{
+			return get(engine, Min, Max);
+		}
+		else
+		{
+			// Draws of the engine's own width, unless the range needs more than 32 bits:
+			constexpr std::uint64_t span{ static_cast<std::uint64_t>(Max) - static_cast<std::uint64_t>(Min) };
+			constexpr bool wide{ bits64<URBG> || span > 0xFFFFFFFFu };
+			using Word = std::conditional_t<wide, std::uint64_t, std::uint32_t>;
+			using Wide = std::conditional_t<wide, unsigned __int128, std::uint64_t>;
+			constexpr int bits{ sizeof(Word) * 8 };
+			constexpr Word range{ static_cast<Word>(span + 1) }; // 0 for the whole of Word
+			auto draw{ [&engine]() -> Word {
+				if constexpr (wide)
+					return next64(engine);
+				else
+					return next32(engine);
+			} };
+			// Min plus an offset below the range, added in T's own width (a Word may be narrower than T, and a
+			// negative Min doesn't survive the trip through an unsigned Word), unsigned so it wraps instead of overflowing:
+			using U = std::make_unsigned_t<T>;
+			auto fromMin{ [](Word offset) { return static_cast<T>(static_cast<U>(static_cast<U>(Min) + static_cast<U>(offset))); } };
+
+			if constexpr ((range & (range - 1)) == 0)
+			{
+				// A power of two: the top bits. Shifting a Word by its width is undefined, hence the whole range
+				// and the single value (Min == Max, which needs no draw at all) on their own.
+				if constexpr (range == 0)
+					return fromMin(draw());
+				else if constexpr (range == 1)
+					return Min;
+				else
+				{
+					constexpr int shift{ bits - __builtin_ctzll(range) };
+					return fromMin(draw() >> shift);
+				}
+			}
+			else
+			{
+				constexpr Word threshold{ static_cast<Word>(-range % range) };
+				Wide product{ static_cast<Wide>(draw()) * range };
+				while (static_cast<Word>(product) < threshold)
+					product = static_cast<Wide>(draw()) * range;
+				return fromMin(static_cast<Word>(product >> bits));
+			}
+		}
+	}
+	template <auto Min, auto Max>
+	inline decltype(Min) get()
+	{
+		return get<Min, Max>(mt);
+	}
 }
 
 #endif
\ No newline at end of file
@@ -33,7 +33,7 @@ class Player
 public:
     Player(std::string_view name)
         : m_name{name}
-        , m_gold{Random::get(80,120)}
+        , m_gold{Random::get<80,120>()}
     {
     }
     // const std::string& getName() const { return m_name; }